@@ -0,0 +1,77 @@
+/**
+ * @file    batch_insert_bench.cpp
+ * @brief   This file contains a benchmark comparing DatabaseManager::addDevices with one addDevice call per device,
+ *          which is what a client looping over POST /devices costs the database.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../src/database/database_manager.hpp"
+
+namespace {
+
+const char* kDatabasePath = "/tmp/batch_insert_bench.db";
+
+std::vector<Device> makeDevices(int count) {
+    std::vector<Device> devices;
+    devices.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        devices.push_back({ 0, "device-" + std::to_string(i), i % 3 ? "sensor" : "robot",
+                            "SN-" + std::to_string(i), "2023-11-26", 1 });
+    }
+    return devices;
+}
+
+void removeDatabase() {
+    for (const char* suffix : { "", "-wal", "-shm" }) {
+        std::remove((std::string(kDatabasePath) + suffix).c_str());
+    }
+}
+
+template <typename Fn>
+double measureRowsPerSecond(const database::DurabilityProfile& profile, int count, Fn&& insert) {
+    removeDatabase();
+    database::DatabaseManager database(kDatabasePath, 1, profile);
+    database.init();
+    database.addLocation({ 0, "Hall A", "Production" });
+    auto started = std::chrono::steady_clock::now();
+    insert(database);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return count / seconds;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Usage: batch_insert_bench [devices] [profile]
+    int count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    auto profile = database::DurabilityProfile::fromName(argc > 2 ? argv[2] : "balanced");
+    if (!profile.has_value()) {
+        std::cerr << "Unknown profile" << std::endl;
+        return 1;
+    }
+    std::vector<Device> devices = makeDevices(count);
+
+    double loop = measureRowsPerSecond(*profile, count, [&](database::DatabaseManager& database) {
+        for (const auto& device : devices) {
+            database.addDevice(device);
+        }
+    });
+    double batch = measureRowsPerSecond(*profile, count, [&](database::DatabaseManager& database) {
+        database.addDevices(devices);
+    });
+    removeDatabase();
+
+    std::cout << "devices=" << count << " profile=" << profile->name << "\n"
+              << "addDevice loop: " << static_cast<long>(loop) << " rows/s\n"
+              << "addDevices:     " << static_cast<long>(batch) << " rows/s\n"
+              << "speedup:        " << batch / loop << "x" << std::endl;
+    return 0;
+}
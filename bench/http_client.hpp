@@ -0,0 +1,89 @@
+/**
+ * @file    http_client.hpp
+ * @brief   This file contains a minimal blocking HTTP/1.1 client used by the benchmark and stress tools.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef HTTP_CLIENT_HPP
+#define HTTP_CLIENT_HPP
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <string>
+
+namespace bench {
+
+struct HttpResponse {
+    int status;         // 0 if the request could not be sent or the response could not be read
+    std::string body;
+};
+
+/**
+ * @brief A function that sends one request on a fresh connection and reads the response until the server closes it.
+ * @param host The IPv4 address of the server.
+ * @param port The port of the server.
+ * @param method The HTTP method, e.g. "GET".
+ * @param path The request target, e.g. "/devices/1".
+ * @param body The request body, sent as application/json when not empty.
+ * @return The status code and body of the response.
+ */
+inline HttpResponse httpRequest(const std::string& host, int port, const std::string& method,
+                                const std::string& path, const std::string& body = "") {
+    HttpResponse response = { 0, "" };
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return response;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return response;
+    }
+
+    std::string request = method + " " + path + " HTTP/1.1\r\nHost: " + host + "\r\nConnection: close\r\n";
+    if (!body.empty()) {
+        request += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+    }
+    request += "\r\n" + body;
+
+    std::size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(fd, request.data() + sent, request.size() - sent, 0);
+        if (n <= 0) {
+            ::close(fd);
+            return response;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+
+    std::string raw;
+    char buffer[16384];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        raw.append(buffer, static_cast<std::size_t>(n));
+    }
+    ::close(fd);
+
+    // Status line: "HTTP/1.1 200 OK"
+    std::size_t space = raw.find(' ');
+    std::size_t header_end = raw.find("\r\n\r\n");
+    if (space == std::string::npos || header_end == std::string::npos) {
+        return response;
+    }
+    response.status = std::atoi(raw.c_str() + space + 1);
+    response.body = raw.substr(header_end + 4);
+    return response;
+}
+
+} // namespace bench
+
+#endif // HTTP_CLIENT_HPP
@@ -0,0 +1,328 @@
+/**
+ * @file    loadgen.cpp
+ * @brief   This file contains an end-to-end load generator: it seeds a database with a synthetic factory fleet,
+ *          starts a ServerManager on localhost and drives a configurable mix of requests from many client
+ *          connections, then reports throughput and latency percentiles per request kind.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/database/database_manager.hpp"
+#include "../src/logging/logger.hpp"
+#include "../src/server/server_manager.hpp"
+#include "http_client.hpp"
+
+namespace {
+
+const char* kHost = "127.0.0.1";
+
+// Device types and their share of the fleet: most devices are cheap sensors, few are PLCs
+const std::vector<std::pair<const char*, double>> kDeviceTypes = {
+    { "sensor", 50 }, { "actuator", 20 }, { "camera", 12 }, { "robot", 8 },
+    { "controller", 5 }, { "gateway", 3 }, { "plc", 2 },
+};
+const char* kLocationTypes[] = { "Production", "Storage", "Lab", "Office" };
+
+struct Options {
+    std::string db_path = "/tmp/loadgen_device.db";
+    int devices = 100000;
+    int locations = 200;
+    int workers = 8;
+    int clients = 32;
+    int duration_s = 10;
+    int port = 18081;
+    bool seed = true;
+    bool snapshot = false;
+    // Weights of the request kinds, see Kind
+    std::map<std::string, int> mix = { { "get", 60 }, { "list", 10 }, { "filter", 15 }, { "location", 5 }, { "write", 10 } };
+};
+
+enum Kind { GET, LIST, FILTER, LOCATION, WRITE, KIND_COUNT };
+const char* kKindNames[] = { "get", "list", "filter", "location", "write" };
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::size_t equals = arg.find('=');
+        std::string key = arg.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+        if (key == "--db") options.db_path = value;
+        else if (key == "--devices") options.devices = std::atoi(value.c_str());
+        else if (key == "--locations") options.locations = std::atoi(value.c_str());
+        else if (key == "--workers") options.workers = std::atoi(value.c_str());
+        else if (key == "--clients") options.clients = std::atoi(value.c_str());
+        else if (key == "--duration") options.duration_s = std::atoi(value.c_str());
+        else if (key == "--port") options.port = std::atoi(value.c_str());
+        else if (key == "--no-seed") options.seed = false;
+        else if (key == "--snapshot") options.snapshot = true;
+        else if (key == "--mix") {
+            // e.g. --mix=get:70,filter:20,write:10
+            options.mix.clear();
+            std::stringstream entries(value);
+            std::string entry;
+            while (std::getline(entries, entry, ',')) {
+                std::size_t colon = entry.find(':');
+                if (colon == std::string::npos) return false;
+                options.mix[entry.substr(0, colon)] = std::atoi(entry.c_str() + colon + 1);
+            }
+        } else {
+            return false;
+        }
+    }
+    for (const auto& weight : options.mix) {
+        if (std::find_if(std::begin(kKindNames), std::end(kKindNames),
+                         [&](const char* name) { return weight.first == name; }) == std::end(kKindNames)) {
+            return false;
+        }
+    }
+    return options.devices > 0 && options.locations > 0 && options.clients > 0 && options.duration_s > 0;
+}
+
+std::string deviceDate(std::mt19937_64& rng) {
+    // Spread over 2015-2025, skewed towards recent years as the fleet grows
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    int year = 2015 + static_cast<int>(10.999 * std::sqrt(unit(rng)));
+    char date[32];
+    std::snprintf(date, sizeof(date), "%04d-%02d-%02d", year, 1 + static_cast<int>(rng() % 12), 1 + static_cast<int>(rng() % 28));
+    return date;
+}
+
+// Devices cluster in a few large halls: location ids follow a Zipf-like distribution
+int skewedLocation(std::mt19937_64& rng, int locations) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    return 1 + static_cast<int>(std::pow(unit(rng), 2.5) * locations) % locations;
+}
+
+Device randomDevice(std::mt19937_64& rng, std::discrete_distribution<int>& types, int locations, const std::string& serial) {
+    const char* type = kDeviceTypes[types(rng)].first;
+    return { 0, std::string(type) + "-" + serial, type, serial, deviceDate(rng), skewedLocation(rng, locations) };
+}
+
+std::discrete_distribution<int> typeDistribution() {
+    std::vector<double> weights;
+    for (const auto& type : kDeviceTypes) weights.push_back(type.second);
+    return std::discrete_distribution<int>(weights.begin(), weights.end());
+}
+
+bool seedDatabase(const Options& options) {
+    for (const char* suffix : { "", "-wal", "-shm" }) {
+        std::remove((options.db_path + suffix).c_str());
+    }
+    database::DatabaseManager database(options.db_path, 1, database::DurabilityProfile::throughput());
+    database.init();
+    for (int i = 0; i < options.locations; ++i) {
+        int plant = i / 20;
+        if (!database.addLocation({ 0, "plant-" + std::to_string(plant) + "-hall-" + std::to_string(i % 20),
+                                    kLocationTypes[i % 4] })) {
+            return false;
+        }
+    }
+    std::mt19937_64 rng(2026);
+    std::discrete_distribution<int> types = typeDistribution();
+    std::vector<Device> batch;
+    for (int start = 0; start < options.devices; start += 10000) {
+        batch.clear();
+        for (int i = start; i < std::min(options.devices, start + 10000); ++i) {
+            batch.push_back(randomDevice(rng, types, options.locations, "SN-" + std::to_string(i)));
+        }
+        if (database.addDevices(batch).inserted != batch.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct ClientStats {
+    std::vector<double> latencies_ms[KIND_COUNT];
+    long errors[KIND_COUNT] = {};
+    long shed[KIND_COUNT] = {};  // 503 from admission control: load shed on purpose, not a failure
+};
+
+std::string toJson(const Device& device) {
+    return "{\"name\":\"" + device.name + "\",\"type\":\"" + device.type + "\",\"serial_number\":\"" +
+           device.serial_number + "\",\"creation_date\":\"" + device.creation_date + "\",\"location_id\":" +
+           std::to_string(device.location_id) + "}";
+}
+
+// Runs one client connection loop until the deadline
+void runClient(int client, const Options& options, std::chrono::steady_clock::time_point deadline, ClientStats& stats) {
+    std::mt19937_64 rng(1000 + client);
+    std::vector<double> weights;
+    for (const char* name : kKindNames) {
+        auto it = options.mix.find(name);
+        weights.push_back(it == options.mix.end() ? 0 : it->second);
+    }
+    std::discrete_distribution<int> kinds(weights.begin(), weights.end());
+    std::discrete_distribution<int> types = typeDistribution();
+    std::uniform_int_distribution<int> ids(1, options.devices);
+    int created = 0;
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        int kind = kinds(rng);
+        std::string method = "GET";
+        std::string path;
+        std::string body;
+        switch (kind) {
+            case GET:
+                path = "/devices/" + std::to_string(ids(rng));
+                break;
+            case LIST:
+                path = "/devices?limit=100&after_id=" + std::to_string(ids(rng) - 1);
+                break;
+            case FILTER: {
+                int filter = static_cast<int>(rng() % 3);
+                if (filter == 0) {
+                    path = "/devices?limit=100&type=" + std::string(kDeviceTypes[types(rng)].first);
+                } else if (filter == 1) {
+                    int location = skewedLocation(rng, options.locations) - 1;
+                    path = "/devices?limit=100&location=plant-" + std::to_string(location / 20) + "-hall-" +
+                           std::to_string(location % 20);
+                } else {
+                    std::string start = deviceDate(rng);
+                    path = "/devices?limit=100&creation_date_start=" + start + "&creation_date_end=" +
+                           start.substr(0, 4) + "-12-31";
+                }
+                break;
+            }
+            case LOCATION:
+                path = "/locations/" + std::to_string(1 + static_cast<int>(rng() % options.locations));
+                break;
+            default: {
+                if (rng() % 4 == 0) {
+                    // Rewrite an existing device with fresh values, keeping its serial number unique
+                    int id = ids(rng);
+                    method = "PUT";
+                    path = "/devices/" + std::to_string(id);
+                    body = toJson(randomDevice(rng, types, options.locations, "SN-U" + std::to_string(client) + "-" +
+                                                                            std::to_string(created++)));
+                } else {
+                    method = "POST";
+                    path = "/devices";
+                    body = toJson(randomDevice(rng, types, options.locations, "SN-C" + std::to_string(client) + "-" +
+                                                                            std::to_string(created++)));
+                }
+            }
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        bench::HttpResponse response = bench::httpRequest(kHost, options.port, method, path, body);
+        double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        stats.latencies_ms[kind].push_back(elapsed_ms);
+        // A 404 is a valid answer for an id that a write deleted or never existed
+        if (response.status == 503) {
+            stats.shed[kind]++;
+        } else if (response.status == 0 || response.status >= 500) {
+            stats.errors[kind]++;
+        }
+    }
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    std::size_t index = static_cast<std::size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, index == 0 ? 0 : index - 1)];
+}
+
+void printRow(const char* name, std::vector<double>& latencies, long errors, long shed, double seconds) {
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("%-9s %9zu %8ld %8ld %10.0f %9.2f %9.2f %9.2f %9.2f\n", name, latencies.size(), errors, shed,
+                latencies.size() / seconds, percentile(latencies, 50), percentile(latencies, 90),
+                percentile(latencies, 99), latencies.empty() ? 0.0 : latencies.back());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: loadgen [--db=PATH] [--devices=N] [--locations=N] [--workers=N] [--clients=N]\n"
+                     "               [--duration=SECONDS] [--port=N] [--no-seed] [--snapshot]\n"
+                     "               [--mix=get:60,list:10,filter:15,location:5,write:10]" << std::endl;
+        return 1;
+    }
+    logging::Logger::instance().configure(logging::Level::Warn, logging::Format::Text, 20);
+
+    if (options.seed) {
+        auto started = std::chrono::steady_clock::now();
+        if (!seedDatabase(options)) {
+            std::cerr << "Failed to seed " << options.db_path << std::endl;
+            return 1;
+        }
+        std::cout << "Seeded " << options.devices << " devices in " << options.locations << " locations in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() << " s"
+                  << std::endl;
+    }
+
+    config::Config config;
+    config.db_path = options.db_path;
+    config.host = kHost;
+    config.port = options.port;
+    config.workers = options.workers;
+    config.db_device_snapshot = options.snapshot;
+    std::string error;
+    if (!config.validate(error)) {
+        std::cerr << "Invalid configuration: " << error << std::endl;
+        return 1;
+    }
+    server::ServerManager server(config);
+    server.init();
+    std::thread server_thread([&server] { server.start(); });
+    for (int attempt = 0; attempt < 100 && bench::httpRequest(kHost, options.port, "GET", "/locations/1").status == 0; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    std::vector<ClientStats> stats(options.clients);
+    std::vector<std::thread> clients;
+    auto started = std::chrono::steady_clock::now();
+    auto deadline = started + std::chrono::seconds(options.duration_s);
+    for (int c = 0; c < options.clients; ++c) {
+        clients.emplace_back(runClient, c, std::cref(options), deadline, std::ref(stats[c]));
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    server.stop();
+    server_thread.join();
+
+    std::printf("workers=%d clients=%d devices=%d duration=%.1fs\n", options.workers, options.clients,
+                options.devices, seconds);
+    std::printf("%-9s %9s %8s %8s %10s %9s %9s %9s %9s\n", "kind", "requests", "errors", "shed", "req/s", "p50 ms", "p90 ms",
+                "p99 ms", "max ms");
+    std::vector<double> all;
+    long total_errors = 0;
+    long total_shed = 0;
+    for (int kind = 0; kind < KIND_COUNT; ++kind) {
+        std::vector<double> latencies;
+        long errors = 0;
+        long shed = 0;
+        for (auto& client : stats) {
+            latencies.insert(latencies.end(), client.latencies_ms[kind].begin(), client.latencies_ms[kind].end());
+            errors += client.errors[kind];
+            shed += client.shed[kind];
+        }
+        if (latencies.empty()) continue;
+        all.insert(all.end(), latencies.begin(), latencies.end());
+        total_errors += errors;
+        total_shed += shed;
+        printRow(kKindNames[kind], latencies, errors, shed, seconds);
+    }
+    printRow("total", all, total_errors, total_shed, seconds);
+    logging::Logger::instance().stop();
+    return total_errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,491 @@
+/**
+ * @file    micro_bench.cpp
+ * @brief   This file contains Google Benchmark micro-benchmarks of the DatabaseManager methods and of the
+ *          JSON and MessagePack response building used by the handlers, run against databases seeded with
+ *          1k, 100k and 1M devices.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../src/database/database_manager.hpp"
+#include "../src/logging/logger.hpp"
+#include "../src/serialization/compression.hpp"
+#include "../src/serialization/json_reader.hpp"
+#include "../src/serialization/json_writer.hpp"
+#include "../src/serialization/msgpack.hpp"
+
+namespace {
+
+const int kLocations = 100;
+const char* kTypes[] = { "sensor", "actuator", "robot", "camera", "controller" };
+
+std::string databasePath(int devices) {
+    return "/tmp/device_micro_bench_" + std::to_string(devices) + ".db";
+}
+
+void removeDatabase(const std::string& path) {
+    for (const char* suffix : { "", "-wal", "-shm" }) {
+        std::remove((path + suffix).c_str());
+    }
+}
+
+Device makeDevice(int i) {
+    char date[32];
+    // The year does not follow the type, so a type and date range filter finds matches for every type
+    std::snprintf(date, sizeof(date), "%04d-%02d-%02d", 2020 + i / 5 % 5, 1 + i % 12, 1 + i % 28);
+    return { 0, "device-" + std::to_string(i), kTypes[i % 5], "SN-" + std::to_string(i), date, 1 + i % kLocations };
+}
+
+// One database per size, seeded on first use and shared by every benchmark of that size
+database::DatabaseManager& seededDatabase(int devices) {
+    static std::map<int, std::unique_ptr<database::DatabaseManager>> databases;
+    auto it = databases.find(devices);
+    if (it != databases.end()) {
+        return *it->second;
+    }
+    std::string path = databasePath(devices);
+    removeDatabase(path);
+    auto database = std::make_unique<database::DatabaseManager>(path, 1, database::DurabilityProfile::throughput());
+    database->init();
+    for (int i = 0; i < kLocations; ++i) {
+        database->addLocation({ 0, "hall-" + std::to_string(i), i % 2 ? "Production" : "Storage" });
+    }
+    const int chunk = 50000;
+    std::vector<Device> batch;
+    for (int start = 0; start < devices; start += chunk) {
+        batch.clear();
+        for (int i = start; i < std::min(devices, start + chunk); ++i) {
+            batch.push_back(makeDevice(i));
+        }
+        database->addDevices(batch);
+    }
+    return *databases.emplace(devices, std::move(database)).first->second;
+}
+
+// A second manager on the seeded database that answers filter queries from the device snapshot. The write
+// benchmarks leave the table as seeded, so the snapshot, loaded once, stays in sync with it.
+database::DatabaseManager& snapshotDatabase(int devices) {
+    static std::map<int, std::unique_ptr<database::DatabaseManager>> databases;
+    auto it = databases.find(devices);
+    if (it != databases.end()) {
+        return *it->second;
+    }
+    seededDatabase(devices);
+    auto database = std::make_unique<database::DatabaseManager>(databasePath(devices), 1,
+                                                                database::DurabilityProfile::throughput());
+    database->setDeviceSnapshot(true);
+    database->init();
+    return *databases.emplace(devices, std::move(database)).first->second;
+}
+
+// Deterministic ids in [1, range], so runs are comparable
+class IdSequence {
+private:
+    std::uint64_t state_ = 42;
+    int range_;
+
+public:
+    explicit IdSequence(int range) : range_(range) {}
+
+    int next() {
+        state_ = state_ * 6364136223846793005ull + 1442695040888963407ull;
+        return 1 + static_cast<int>((state_ >> 33) % static_cast<std::uint64_t>(range_));
+    }
+};
+
+// Deletes the rows a write benchmark added, so the seeded size stays the same for the next benchmark
+void removeDevicesAfter(database::DatabaseManager& database, int last_seeded_id) {
+    for (;;) {
+        std::vector<Device> added = database.getDevicesPage(last_seeded_id, 10000);
+        if (added.empty()) break;
+        for (const auto& device : added) {
+            database.deleteDevice(device.id);
+        }
+    }
+}
+
+void BM_GetDevice(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    IdSequence ids(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(database.getDevice(ids.next()));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_GetDeviceCached(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    database.setCacheCapacities(10000, 1000);
+    IdSequence ids(1000);  // A working set that fits in the cache
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(database.getDevice(ids.next()));
+    }
+    database.setCacheCapacities(0, 0);
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_GetAllDevices(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(database.getAllDevices());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ForEachDevice(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    for (auto _ : state) {
+        long long ids = 0;
+        database.forEachDevice([&](const DeviceView& device) { ids += device.id; });
+        benchmark::DoNotOptimize(ids);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_GetDevicesPage(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    IdSequence ids(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(database.getDevicesPage(ids.next(), 101));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void filterByLocation(benchmark::State& state, database::DatabaseManager& database) {
+    IdSequence locations(kLocations);
+    for (auto _ : state) {
+        std::string location = "hall-" + std::to_string(locations.next() - 1);
+        benchmark::DoNotOptimize(database.getDevicesWithFilters("", "", "", "", "", location, 0, 101));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void filterByTypeAndDate(benchmark::State& state, database::DatabaseManager& database) {
+    IdSequence types(5);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(database.getDevicesWithFilters("", kTypes[types.next() - 1], "", "2022-03-01",
+                                                                "2022-06-30", "", 0, 101));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void filterBySerialNumber(benchmark::State& state, database::DatabaseManager& database) {
+    IdSequence ids(state.range(0));
+    for (auto _ : state) {
+        std::string serial = "SN-" + std::to_string(ids.next() - 1);
+        benchmark::DoNotOptimize(database.getDevicesWithFilters("", "", serial, "", "", "", 0, 101));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_FilterByLocation(benchmark::State& state) {
+    filterByLocation(state, seededDatabase(state.range(0)));
+}
+
+void BM_FilterByLocationSnapshot(benchmark::State& state) {
+    filterByLocation(state, snapshotDatabase(state.range(0)));
+}
+
+void BM_FilterByTypeAndDate(benchmark::State& state) {
+    filterByTypeAndDate(state, seededDatabase(state.range(0)));
+}
+
+void BM_FilterByTypeAndDateSnapshot(benchmark::State& state) {
+    filterByTypeAndDate(state, snapshotDatabase(state.range(0)));
+}
+
+void BM_FilterBySerialNumber(benchmark::State& state) {
+    filterBySerialNumber(state, seededDatabase(state.range(0)));
+}
+
+void BM_FilterBySerialNumberSnapshot(benchmark::State& state) {
+    filterBySerialNumber(state, snapshotDatabase(state.range(0)));
+}
+
+// GET /devices/stats: the second argument is the database::DeviceGrouping
+void BM_CountDevices(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    auto grouping = static_cast<database::DeviceGrouping>(state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(database.countDevices(grouping));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// GET /changes: a page of the change log, read from the middle of a full log
+void BM_ReadChanges(benchmark::State& state) {
+    database::ChangeLog changes(100000);
+    for (int id = 1; id <= 100000; ++id) {
+        changes.append(ChangeEntity::Device, id, ChangeOperation::Update);
+    }
+    std::uint64_t since = changes.lastSeq() - 50000;
+    std::vector<Change> page;
+    for (auto _ : state) {
+        changes.read(since, static_cast<std::size_t>(state.range(0)), page);
+        benchmark::DoNotOptimize(page.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_AddDevice(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    int next = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(database.addDevice(makeDevice(next++)));
+    }
+    state.SetItemsProcessed(state.iterations());
+    removeDevicesAfter(database, state.range(0));
+}
+
+void BM_AddDevicesBatch(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    int next = static_cast<int>(state.range(0));
+    std::vector<Device> batch(1000);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (auto& device : batch) {
+            device = makeDevice(next++);
+        }
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(database.addDevices(batch));
+    }
+    state.SetItemsProcessed(state.iterations() * batch.size());
+    removeDevicesAfter(database, state.range(0));
+}
+
+void BM_UpdateDevice(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    IdSequence ids(state.range(0));
+    for (auto _ : state) {
+        int id = ids.next();
+        Device device = makeDevice(id - 1);  // Same values, so the table stays as seeded
+        device.id = id;
+        benchmark::DoNotOptimize(database.updateDevice(device));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DeleteDevice(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    int next = static_cast<int>(state.range(0));
+    int last_id = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        database.addDevice(makeDevice(next++));
+        std::vector<Device> added = database.getDevicesPage(last_id, 1);
+        last_id = added.empty() ? last_id : added.front().id;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(database.deleteDevice(last_id));
+    }
+    state.SetItemsProcessed(state.iterations());
+    removeDevicesAfter(database, state.range(0));
+}
+
+void BM_GetLocation(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    IdSequence ids(kLocations);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(database.getLocation(ids.next()));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_GetLocationsPage(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(database.getLocationsPage(0, 101));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// The body of GET /devices/{id}
+void BM_SerializeDevice(benchmark::State& state) {
+    Device device = makeDevice(12345);
+    device.id = 12346;
+    serialization::JsonWriter writer;
+    for (auto _ : state) {
+        writer.clear();
+        writer.writeDevice(device);
+        writer.append('\n');
+        benchmark::DoNotOptimize(writer.str().data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// The body of a GET /devices page of the given size
+void BM_SerializeDevicesPage(benchmark::State& state) {
+    std::vector<Device> devices;
+    for (int i = 0; i < state.range(0); ++i) {
+        devices.push_back(makeDevice(i));
+        devices.back().id = i + 1;
+    }
+    serialization::JsonWriter writer;
+    for (auto _ : state) {
+        writer.clear();
+        writer.writeDevices(devices);
+        writer.append('\n');
+        benchmark::DoNotOptimize(writer.str().data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * writer.size());
+    state.counters["body_bytes"] = static_cast<double>(writer.size());
+}
+
+// The same page as MessagePack, for Accept: application/msgpack
+void BM_SerializeDevicesPageMsgpack(benchmark::State& state) {
+    std::vector<Device> devices;
+    for (int i = 0; i < state.range(0); ++i) {
+        devices.push_back(makeDevice(i));
+        devices.back().id = i + 1;
+    }
+    serialization::MsgpackWriter writer;
+    for (auto _ : state) {
+        writer.clear();
+        writer.writeDevices(devices);
+        benchmark::DoNotOptimize(writer.str().data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * writer.size());
+    state.counters["body_bytes"] = static_cast<double>(writer.size());
+}
+
+// A POST /devices/batch body of the given size sent as a JSON array
+void BM_DecodeDevicesJson(benchmark::State& state) {
+    serialization::JsonWriter writer;
+    std::vector<Device> source;
+    for (int i = 0; i < state.range(0); ++i) {
+        source.push_back(makeDevice(i));
+    }
+    writer.writeDevices(source);
+    std::vector<Device> devices;
+    std::string error;
+    for (auto _ : state) {
+        devices.clear();
+        serialization::JsonReader reader(writer.str());
+        reader.beginArray();
+        while (reader.nextElement()) {
+            devices.emplace_back();
+            reader.readDevice(devices.back(), error);
+        }
+        benchmark::DoNotOptimize(devices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * writer.size());
+}
+
+// The same body sent as MessagePack
+void BM_DecodeDevicesMsgpack(benchmark::State& state) {
+    serialization::MsgpackWriter writer;
+    writer.writeArrayHeader(state.range(0));
+    for (int i = 0; i < state.range(0); ++i) {
+        writer.writeDevice(makeDevice(i));
+    }
+    std::vector<Device> devices;
+    std::string error;
+    for (auto _ : state) {
+        devices.clear();
+        serialization::MsgpackReader reader(writer.str());
+        std::size_t size = 0;
+        reader.readArrayHeader(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            devices.emplace_back();
+            reader.readDevice(devices.back(), error);
+        }
+        benchmark::DoNotOptimize(devices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// gzip of a 1000-device GET /devices page at the given zlib level; the counters show the compressed size
+void BM_CompressDevicesPage(benchmark::State& state) {
+    std::vector<Device> devices;
+    for (int i = 0; i < 1000; ++i) {
+        devices.push_back(makeDevice(i));
+        devices.back().id = i + 1;
+    }
+    serialization::JsonWriter writer;
+    writer.writeDevices(devices);
+    std::string compressed;
+    for (auto _ : state) {
+        serialization::compress(writer.str(), serialization::ContentEncoding::Gzip, static_cast<int>(state.range(0)), compressed);
+        benchmark::DoNotOptimize(compressed.data());
+    }
+    state.SetBytesProcessed(state.iterations() * writer.size());
+    state.counters["ratio"] = static_cast<double>(writer.size()) / compressed.size();
+}
+
+// GET /devices/export: rows streamed from SQLite into NDJSON, flushed every 64KB
+void BM_ExportNdjson(benchmark::State& state) {
+    database::DatabaseManager& database = seededDatabase(state.range(0));
+    serialization::JsonWriter writer;
+    for (auto _ : state) {
+        std::size_t bytes = 0;
+        writer.clear();
+        database.forEachDevice([&](const DeviceView& device) {
+            writer.writeDevice(device);
+            writer.append('\n');
+            if (writer.size() >= 64 * 1024) {
+                bytes += writer.size();
+                writer.clear();
+            }
+        });
+        benchmark::DoNotOptimize(bytes += writer.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void DatabaseSizes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->Arg(1000)->Arg(100000)->Arg(1000000);
+}
+
+} // namespace
+
+BENCHMARK(BM_GetDevice)->Apply(DatabaseSizes);
+BENCHMARK(BM_GetDeviceCached)->Apply(DatabaseSizes);
+BENCHMARK(BM_GetAllDevices)->Apply(DatabaseSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ForEachDevice)->Apply(DatabaseSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GetDevicesPage)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterByLocation)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterByLocationSnapshot)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterByTypeAndDate)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterByTypeAndDateSnapshot)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBySerialNumber)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBySerialNumberSnapshot)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CountDevices)->ArgsProduct({ { 1000, 100000, 1000000 }, { 0, 1, 2 } })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReadChanges)->Arg(100)->Arg(1000);
+BENCHMARK(BM_AddDevice)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AddDevicesBatch)->Apply(DatabaseSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UpdateDevice)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DeleteDevice)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetLocation)->Apply(DatabaseSizes);
+BENCHMARK(BM_GetLocationsPage)->Apply(DatabaseSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SerializeDevice);
+BENCHMARK(BM_SerializeDevicesPage)->Arg(100)->Arg(1000);
+BENCHMARK(BM_SerializeDevicesPageMsgpack)->Arg(100)->Arg(1000);
+BENCHMARK(BM_DecodeDevicesJson)->Arg(100)->Arg(1000);
+BENCHMARK(BM_DecodeDevicesMsgpack)->Arg(100)->Arg(1000);
+BENCHMARK(BM_CompressDevicesPage)->Arg(1)->Arg(6)->Arg(9)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ExportNdjson)->Apply(DatabaseSizes)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char* argv[]) {
+    // Seeding logs every migration; keep the console for the results
+    logging::Logger::instance().configure(logging::Level::Warn, logging::Format::Text, 0);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    for (int devices : { 1000, 100000, 1000000 }) {
+        removeDatabase(databasePath(devices));
+    }
+    logging::Logger::instance().stop();
+    return 0;
+}
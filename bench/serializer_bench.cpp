@@ -0,0 +1,140 @@
+/**
+ * @file    serializer_bench.cpp
+ * @brief   This file contains a benchmark comparing the JsonWriter with the Json::Value/toStyledString path
+ *          previously used by the GET handlers, the JsonReader with the Json::Value parsing previously used by the
+ *          POST handlers, and both JSON paths with the MessagePack format.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <jsoncpp/json/json.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../src/serialization/json_reader.hpp"
+#include "../src/serialization/json_writer.hpp"
+#include "../src/serialization/msgpack.hpp"
+
+namespace {
+
+std::vector<Device> makeDevices(int count) {
+    std::vector<Device> devices;
+    devices.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        devices.push_back({ i + 1, "Press \"" + std::to_string(i) + "\"", i % 3 ? "sensor" : "robot",
+                            "SN-" + std::to_string(100000 + i), "2023-11-26", 1 + i % 50 });
+    }
+    return devices;
+}
+
+std::string serializeWithJsonCpp(const std::vector<Device>& devices) {
+    Json::Value jsonResponse;
+    for (const auto& device : devices) {
+        Json::Value jsonDevice;
+        jsonDevice["id"] = device.id;
+        jsonDevice["name"] = device.name;
+        jsonDevice["type"] = device.type;
+        jsonDevice["serial_number"] = device.serial_number;
+        jsonDevice["creation_date"] = device.creation_date;
+        jsonDevice["location_id"] = device.location_id;
+        jsonResponse.append(jsonDevice);
+    }
+    return jsonResponse.toStyledString();
+}
+
+// Decodes a POST /devices/batch body the way the handlers did before the JsonReader
+std::size_t parseWithJsonCpp(const std::string& body) {
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    Json::Value array;
+    std::string errors;
+    reader->parse(body.data(), body.data() + body.size(), &array, &errors);
+    std::size_t decoded = 0;
+    for (const auto& item : array) {
+        Device device{ 0, item["name"].asString(), item["type"].asString(), item["serial_number"].asString(),
+                       item["creation_date"].asString(), item["location_id"].asInt() };
+        decoded += !device.name.empty();
+    }
+    return decoded;
+}
+
+std::size_t parseWithJsonReader(const std::string& body) {
+    serialization::JsonReader reader(body);
+    reader.beginArray();
+    std::size_t decoded = 0;
+    Device device;
+    std::string error;
+    while (reader.nextElement()) {
+        decoded += reader.readDevice(device, error);
+    }
+    return decoded;
+}
+
+std::size_t parseWithMsgpack(const std::string& body) {
+    serialization::MsgpackReader reader(body);
+    std::size_t size = 0;
+    reader.readArrayHeader(size);
+    std::size_t decoded = 0;
+    Device device;
+    std::string error;
+    for (std::size_t i = 0; i < size; ++i) {
+        decoded += reader.readDevice(device, error);
+    }
+    return decoded;
+}
+
+template <typename Fn>
+double measureMs(int iterations, Fn&& fn) {
+    auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Usage: serializer_bench [devices] [iterations]
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+    std::vector<Device> devices = makeDevices(count);
+
+    std::size_t jsoncpp_bytes = 0;
+    double jsoncpp_ms = measureMs(iterations, [&] { jsoncpp_bytes = serializeWithJsonCpp(devices).size(); });
+
+    serialization::JsonWriter writer;
+    std::size_t writer_bytes = 0;
+    double writer_ms = measureMs(iterations, [&] {
+        writer.clear();
+        writer.writeDevices(devices);
+        writer_bytes = writer.str().size();
+    });
+
+    serialization::MsgpackWriter msgpack;
+    std::size_t msgpack_bytes = 0;
+    double msgpack_ms = measureMs(iterations, [&] {
+        msgpack.clear();
+        msgpack.writeDevices(devices);
+        msgpack_bytes = msgpack.size();
+    });
+
+    std::size_t decoded = 0;
+    double jsoncpp_parse_ms = measureMs(iterations, [&] { decoded = parseWithJsonCpp(writer.str()); });
+    double reader_parse_ms = measureMs(iterations, [&] { decoded = parseWithJsonReader(writer.str()); });
+    double msgpack_parse_ms = measureMs(iterations, [&] { decoded = parseWithMsgpack(msgpack.str()); });
+
+    std::cout << "devices=" << count << " iterations=" << iterations << "\n"
+              << "jsoncpp:     " << jsoncpp_ms << " ms/op, " << jsoncpp_bytes << " bytes\n"
+              << "json_writer: " << writer_ms << " ms/op, " << writer_bytes << " bytes\n"
+              << "msgpack:     " << msgpack_ms << " ms/op, " << msgpack_bytes << " bytes\n"
+              << "speedup:     " << jsoncpp_ms / writer_ms << "x\n"
+              << "decode jsoncpp:     " << jsoncpp_parse_ms << " ms/op\n"
+              << "decode json_reader: " << reader_parse_ms << " ms/op\n"
+              << "decode msgpack:     " << msgpack_parse_ms << " ms/op (" << decoded << " devices)" << std::endl;
+    return 0;
+}
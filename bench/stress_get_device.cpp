@@ -0,0 +1,96 @@
+/**
+ * @file    stress_get_device.cpp
+ * @brief   This file contains a stress tool that drives many concurrent GET /devices/{id} requests
+ *          against an in-process ServerManager and fails if any of them does not succeed.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../src/database/database_manager.hpp"
+#include "../src/server/server_manager.hpp"
+#include "http_client.hpp"
+
+namespace {
+
+const char* kDatabasePath = "/tmp/stress_get_device.db";
+const char* kHost = "127.0.0.1";
+
+void seedDatabase(int device_count) {
+    std::remove(kDatabasePath);
+    database::DatabaseManager database(kDatabasePath);
+    database.init();
+    database.addLocation({ 0, "Hall A", "Production" });
+    for (int i = 0; i < device_count; ++i) {
+        database.addDevice({ 0, "device-" + std::to_string(i), "sensor", "SN-" + std::to_string(i), "2023-11-26", 1 });
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Usage: stress_get_device [workers] [client_threads] [requests_per_client] [devices] [port]
+    int workers = argc > 1 ? std::atoi(argv[1]) : 8;
+    int clients = argc > 2 ? std::atoi(argv[2]) : 32;
+    int requests_per_client = argc > 3 ? std::atoi(argv[3]) : 500;
+    int device_count = argc > 4 ? std::atoi(argv[4]) : 1000;
+    int port = argc > 5 ? std::atoi(argv[5]) : 18080;
+
+    seedDatabase(device_count);
+
+    config::Config config;
+    config.db_path = kDatabasePath;
+    config.host = kHost;
+    config.port = port;
+    config.workers = workers;
+    std::string error;
+    if (!config.validate(error)) {
+        std::cerr << "Invalid configuration: " << error << std::endl;
+        return 1;
+    }
+    server::ServerManager server(config);
+    server.init();
+    std::thread server_thread([&server] { server.start(); });
+
+    // Wait until the server accepts connections
+    for (int attempt = 0; attempt < 100 && bench::httpRequest(kHost, port, "GET", "/devices/1").status == 0; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    std::atomic<int> ok(0);
+    std::atomic<int> failed(0);
+    auto started = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            for (int i = 0; i < requests_per_client; ++i) {
+                int id = 1 + (c * requests_per_client + i) % device_count;
+                bench::HttpResponse response = bench::httpRequest(kHost, port, "GET", "/devices/" + std::to_string(id));
+                if (response.status == 200) {
+                    ok++;
+                } else {
+                    if (failed++ < 10) {
+                        std::cerr << "GET /devices/" << id << " failed with status " << response.status << std::endl;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    server.stop();
+    server_thread.join();
+
+    std::cout << "workers=" << workers << " clients=" << clients << " ok=" << ok << " failed=" << failed
+              << " throughput=" << static_cast<int>(ok / seconds) << " req/s" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
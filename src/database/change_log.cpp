@@ -0,0 +1,88 @@
+/**
+ * @file    change_log.cpp
+ * @brief   This file contains the implementation of the ChangeLog class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <algorithm>
+#include "change_log.hpp"
+
+namespace database {
+
+ChangeLog::ChangeLog(std::size_t capacity)
+    : capacity_(std::max<std::size_t>(capacity, 1))
+    // Leaves room for 1000 changes per millisecond of uptime before a later start could reuse a number
+    , last_seq_(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count()) * 1000)
+    , closed_(false) {}
+
+void ChangeLog::appendUnlocked(ChangeEntity entity, int id, ChangeOperation operation) {
+    if (changes_.size() == capacity_) {
+        changes_.pop_front();
+    }
+    changes_.push_back(Change{ ++last_seq_, id, entity, operation });
+}
+
+void ChangeLog::append(ChangeEntity entity, int id, ChangeOperation operation) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        appendUnlocked(entity, id, operation);
+    }
+    changed_.notify_all();
+}
+
+void ChangeLog::append(ChangeEntity entity, const std::vector<int>& ids, ChangeOperation operation) {
+    if (ids.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int id : ids) {
+            appendUnlocked(entity, id, operation);
+        }
+    }
+    changed_.notify_all();
+}
+
+ChangeRead ChangeLog::read(std::uint64_t since, std::size_t limit, std::vector<Change>& changes) const {
+    changes.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::uint64_t first_seq = last_seq_ - changes_.size() + 1;  // last_seq_ + 1 while the log is empty
+    if (since + 1 < first_seq || since > last_seq_) {
+        return ChangeRead::Expired;
+    }
+    auto begin = changes_.begin() + static_cast<std::ptrdiff_t>(since + 1 - first_seq);
+    auto end = begin + static_cast<std::ptrdiff_t>(std::min<std::uint64_t>(limit, last_seq_ - since));
+    changes.assign(begin, end);
+    return ChangeRead::Ok;
+}
+
+bool ChangeLog::waitFor(std::uint64_t since, std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, timeout, [&] { return last_seq_ > since || closed_; }) && last_seq_ > since;
+}
+
+void ChangeLog::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    changed_.notify_all();
+}
+
+std::uint64_t ChangeLog::lastSeq() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_seq_;
+}
+
+void ChangeLog::setCapacity(std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = std::max<std::size_t>(capacity, 1);
+    while (changes_.size() > capacity_) {
+        changes_.pop_front();
+    }
+}
+
+} // namespace database
@@ -0,0 +1,119 @@
+/**
+ * @file    change_log.hpp
+ * @brief   This file contains the declaration of the ChangeLog class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef CHANGE_LOG_HPP
+#define CHANGE_LOG_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "../utilities/metadata.hpp"
+
+namespace database {
+
+/**
+ * @brief The outcome of reading the change log from a cursor.
+ */
+enum class ChangeRead {
+    Ok,       // The changes after the cursor were returned, possibly none
+    Expired,  // The cursor is older than the retained changes, or was not issued by this process
+};
+
+/**
+ * @brief A bounded, in-memory log of the writes applied through a DatabaseManager, which clients tail with
+ *        a sequence number instead of polling the listings. The oldest changes are dropped once the log
+ *        holds its capacity, and a reader whose cursor fell behind them must re-read the listings.
+ *
+ *        Sequence numbers start at the startup time in milliseconds times 1000, so those issued by a
+ *        previous process are below the retained ones and are reported as expired rather than silently
+ *        resumed. Readers can wait for the next change, which keeps long-polls off the database.
+ */
+class ChangeLog {
+private:
+    mutable std::mutex mutex_;
+    mutable std::condition_variable changed_;  // Notified on every append and on close
+    std::deque<Change> changes_;               // Contiguous sequence numbers, oldest first
+    std::size_t capacity_;
+    std::uint64_t last_seq_;                   // The sequence number of the newest change, or the start one
+    bool closed_;
+
+    /**
+     * @brief A member function that appends a change and drops the oldest one if the log is full,
+     *        without taking the lock.
+     * @param entity The kind of row written.
+     * @param id The id of the row.
+     * @param operation The write.
+     */
+    void appendUnlocked(ChangeEntity entity, int id, ChangeOperation operation);
+
+public:
+    /**
+     * @brief A constructor for the ChangeLog class.
+     * @param capacity The number of changes retained, at least 1.
+     */
+    explicit ChangeLog(std::size_t capacity);
+
+    /**
+     * @brief A member function that records a write and wakes the waiting readers.
+     * @param entity The kind of row written.
+     * @param id The id of the row.
+     * @param operation The write.
+     */
+    void append(ChangeEntity entity, int id, ChangeOperation operation);
+
+    /**
+     * @brief A member function that records the same write on several rows, e.g. the inserts of a batch.
+     * @param entity The kind of rows written.
+     * @param ids The ids of the rows, in the order they were written.
+     * @param operation The write.
+     */
+    void append(ChangeEntity entity, const std::vector<int>& ids, ChangeOperation operation);
+
+    /**
+     * @brief A member function that returns the changes after a cursor.
+     * @param since The sequence number of the last change the reader has seen.
+     * @param limit The maximum number of changes returned.
+     * @param changes Set to the changes after since, oldest first.
+     * @return Ok, or Expired if changes after since were already dropped or since was never issued.
+     */
+    ChangeRead read(std::uint64_t since, std::size_t limit, std::vector<Change>& changes) const;
+
+    /**
+     * @brief A member function that waits until a change after a cursor is recorded.
+     * @param since The sequence number of the last change the reader has seen.
+     * @param timeout The longest wait.
+     * @return True if a change after since is available, false on timeout or once the log is closed.
+     */
+    bool waitFor(std::uint64_t since, std::chrono::milliseconds timeout) const;
+
+    /**
+     * @brief A member function that wakes every waiting reader and makes later waits return immediately,
+     *        so long-polls do not hold up a shutdown.
+     */
+    void close();
+
+    /**
+     * @brief A member function that returns the sequence number of the newest change, which is the cursor
+     *        of a reader that has seen everything.
+     * @return The sequence number.
+     */
+    std::uint64_t lastSeq() const;
+
+    /**
+     * @brief A member function that changes the number of changes retained, dropping the oldest ones if needed.
+     * @param capacity The number of changes retained, at least 1.
+     */
+    void setCapacity(std::size_t capacity);
+};
+
+} // namespace database
+
+#endif // CHANGE_LOG_HPP
@@ -0,0 +1,108 @@
+/**
+ * @file    connection_pool.cpp
+ * @brief   This file contains the implementation of the ConnectionPool class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include "../logging/logger.hpp"
+#include "../metrics/metrics.hpp"
+#include "../tracing/trace.hpp"
+#include "connection_pool.hpp"
+
+namespace database {
+
+Connection::Connection(sqlite3* db)
+    : db_(db)
+    , statements_(std::make_unique<StatementCache>(db)) {}
+
+Connection::~Connection() {
+    statements_.reset();  // Statements must be finalized before the connection is closed
+    sqlite3_close(db_);
+}
+
+ConnectionPool::ConnectionPool(const std::string& db_name, std::size_t size)
+    : db_name_(db_name)
+    , size_(size == 0 ? 1 : size)
+    , closing_(false) {}
+
+ConnectionPool::~ConnectionPool() {
+    close();
+}
+
+bool ConnectionPool::open(const std::function<bool(sqlite3*)>& configure) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closing_ = false;
+    // Every connection is used by one thread at a time, so SQLite's per-connection mutex is not needed
+    const int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
+    for (std::size_t i = 0; i < size_; ++i) {
+        sqlite3* db = nullptr;
+        if (sqlite3_open_v2(db_name_.c_str(), &db, flags, nullptr) != SQLITE_OK) {
+            logging::error() << "Error opening database: " << sqlite3_errmsg(db);
+            sqlite3_close(db);
+            idle_.clear();
+            connections_.clear();
+            return false;
+        }
+        auto connection = std::make_unique<Connection>(db);
+        if (!configure(db)) {
+            idle_.clear();
+            connections_.clear();
+            return false;
+        }
+        idle_.push_back(connection.get());
+        connections_.push_back(std::move(connection));
+    }
+    return true;
+}
+
+void ConnectionPool::close(const std::function<void(sqlite3*)>& before_close) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    closing_ = true;
+    available_.notify_all();  // Wake waiters so they give up instead of blocking forever
+    // A handler still inside a transaction finishes it before its connection goes away
+    available_.wait(lock, [this] { return idle_.size() == connections_.size(); });
+    if (before_close && !connections_.empty()) {
+        before_close(connections_.front()->handle());
+    }
+    idle_.clear();
+    connections_.clear();
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    static metrics::Histogram& wait = metrics::Registry::global().histogram(
+        "db_connection_wait_seconds", "Time spent waiting for an idle pooled connection");
+    metrics::ScopedTimer timer(wait);
+    tracing::ScopedSpan span("acquire_connection", "db");
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait(lock, [this] { return !idle_.empty() || connections_.empty() || closing_; });
+    if (connections_.empty() || closing_) {
+        return Lease(this, nullptr);
+    }
+    Connection* connection = idle_.back();
+    idle_.pop_back();
+    return Lease(this, connection);
+}
+
+void ConnectionPool::release(Connection* connection) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(connection);
+    }
+    available_.notify_all();  // A waiter in close() must not consume the wakeup meant for acquire()
+}
+
+StatementCacheStats ConnectionPool::statementCacheStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    StatementCacheStats total = { 0, 0, 0 };
+    for (const auto& connection : connections_) {
+        StatementCacheStats stats = connection->statements().stats();
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.size += stats.size;
+    }
+    return total;
+}
+
+} // namespace database
@@ -0,0 +1,150 @@
+/**
+ * @file    connection_pool.hpp
+ * @brief   This file contains the declaration of the ConnectionPool class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef CONNECTION_POOL_HPP
+#define CONNECTION_POOL_HPP
+
+#include <sqlite3.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "statement_cache.hpp"
+
+namespace database {
+
+/**
+ * @brief A single SQLite connection together with its prepared statements.
+ */
+class Connection {
+private:
+    sqlite3* db_;
+    std::unique_ptr<StatementCache> statements_;
+
+public:
+    /**
+     * @brief A constructor for the Connection class. Takes ownership of the given handle.
+     * @param db The opened SQLite connection.
+     */
+    explicit Connection(sqlite3* db);
+
+    /**
+     * @brief A destructor for the Connection class. Finalizes the statements and closes the handle.
+     */
+    ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    sqlite3* handle() const { return db_; }
+
+    StatementCache& statements() { return *statements_; }
+
+    const StatementCache& statements() const { return *statements_; }
+};
+
+class ConnectionPool {
+private:
+    std::string db_name_;
+    std::size_t size_;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::vector<Connection*> idle_;
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    bool closing_;
+
+    /**
+     * @brief A member function that returns a leased connection to the pool.
+     * @param connection The connection to be returned.
+     */
+    void release(Connection* connection);
+
+public:
+    /**
+     * @brief An RAII handle on a connection checked out of the pool. The connection is
+     *        returned to the pool when the lease goes out of scope.
+     */
+    class Lease {
+    private:
+        ConnectionPool* pool_;
+        Connection* connection_;
+
+    public:
+        Lease(ConnectionPool* pool, Connection* connection) : pool_(pool), connection_(connection) {}
+
+        ~Lease() {
+            if (connection_) {
+                pool_->release(connection_);
+            }
+        }
+
+        Lease(Lease&& other) noexcept : pool_(other.pool_), connection_(other.connection_) {
+            other.connection_ = nullptr;
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        Connection* operator->() const { return connection_; }
+
+        Connection& operator*() const { return *connection_; }
+
+        explicit operator bool() const { return connection_ != nullptr; }
+    };
+
+    /**
+     * @brief A constructor for the ConnectionPool class.
+     * @param db_name The name of the database.
+     * @param size The number of connections in the pool.
+     */
+    ConnectionPool(const std::string& db_name, std::size_t size);
+
+    /**
+     * @brief A destructor for the ConnectionPool class.
+     */
+    ~ConnectionPool();
+
+    /**
+     * @brief A member function that opens every connection of the pool.
+     * @param configure A callable applied to each connection right after it is opened, e.g. to set pragmas.
+     * @return True if every connection is opened and configured successfully, false otherwise.
+     */
+    bool open(const std::function<bool(sqlite3*)>& configure);
+
+    /**
+     * @brief A member function that closes every connection of the pool. New leases are refused at once;
+     *        the connections are closed when every outstanding lease has been returned.
+     * @param before_close A callable applied to one connection once the pool is idle, e.g. to checkpoint the WAL.
+     */
+    void close(const std::function<void(sqlite3*)>& before_close = nullptr);
+
+    /**
+     * @brief A member function that checks a connection out of the pool, waiting until one is idle.
+     * @return The lease on the connection, an empty lease if the pool is not open or is closing.
+     */
+    Lease acquire();
+
+    /**
+     * @brief A member function that returns the number of connections in the pool.
+     * @return The pool size.
+     */
+    std::size_t size() const { return size_; }
+
+    /**
+     * @brief A member function that returns the statement cache counters summed over every connection.
+     * @return The summed counters.
+     */
+    StatementCacheStats statementCacheStats() const;
+};
+
+} // namespace database
+
+#endif // CONNECTION_POOL_HPP
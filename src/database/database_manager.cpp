@@ -6,14 +6,111 @@
  * @version 1.0
  */
 
-#include <iostream>
+#include <algorithm>
+#include "../logging/logger.hpp"
+#include "../metrics/metrics.hpp"
+#include "../tracing/trace.hpp"
 #include "database_manager.hpp"
+#include "schema_migrations.hpp"
 
 namespace database {
 
-DatabaseManager::DatabaseManager(const std::string& db_name) 
+namespace {
+
+// Bits of the getDevicesWithFilters variant mask, one per optional filter.
+enum FilterBit : std::uint32_t {
+    FILTER_NAME = 1 << 0,
+    FILTER_TYPE = 1 << 1,
+    FILTER_SERIAL_NUMBER = 1 << 2,
+    FILTER_CREATION_DATE_START = 1 << 3,
+    FILTER_CREATION_DATE_END = 1 << 4,
+    FILTER_LOCATION = 1 << 5,
+};
+
+// CROSS JOIN keeps devices as the outer loop, so every variant walks the primary key or an index equality
+// (name, type, serial number or location id, each ending in the id) in id order and stops at the limit, with no sort.
+// The location name is resolved to its ids beforehand, see getDevicesWithFilters.
+std::string buildFilterSql(std::uint32_t mask) {
+    std::string sql = "SELECT devices.* FROM devices CROSS JOIN locations ON devices.location_id = locations.id WHERE 1 = 1";
+    if (mask & FILTER_NAME) sql += " AND devices.name = ?";
+    if (mask & FILTER_TYPE) sql += " AND devices.type = ?";
+    if (mask & FILTER_SERIAL_NUMBER) sql += " AND devices.serial_number = ?";
+    if (mask & FILTER_CREATION_DATE_START) sql += " AND devices.creation_date >= ?";
+    if (mask & FILTER_CREATION_DATE_END) sql += " AND devices.creation_date <= ?";
+    if (mask & FILTER_LOCATION) sql += " AND devices.location_id = ?";
+    return sql + " AND devices.id > ? ORDER BY devices.id LIMIT ?;";
+}
+
+// Every grouping yields (key, location id, count) rows, so one reader serves them all. Each GROUP BY walks
+// an index in key order instead of sorting; days are folded into months by countDevices.
+const char* countDevicesSql(DeviceGrouping grouping) {
+    switch (grouping) {
+        case DeviceGrouping::Type:
+            return "SELECT type, 0, COUNT(*) FROM devices GROUP BY type ORDER BY type;";
+        case DeviceGrouping::Location:
+            return "SELECT locations.name, devices.location_id, COUNT(*) FROM devices "
+                   "INNER JOIN locations ON devices.location_id = locations.id "
+                   "GROUP BY devices.location_id ORDER BY devices.location_id;";
+        case DeviceGrouping::CreationMonth:
+            return "SELECT creation_date, 0, COUNT(*) FROM devices GROUP BY creation_date ORDER BY creation_date;";
+    }
+    return nullptr;
+}
+
+// Each public call records its latency under its own operation label, resolved once per call site
+metrics::Histogram& operationLatency(const char* operation) {
+    return metrics::Registry::global().histogram("db_operation_duration_seconds",
+                                                 "Time spent in DatabaseManager calls, including the wait for a connection",
+                                                 { { "operation", operation } });
+}
+
+// Times a call for the metrics and, when the request is traced, records it as a span
+class OperationScope {
+private:
+    metrics::ScopedTimer timer_;
+    tracing::ScopedSpan span_;
+
+public:
+    OperationScope(metrics::Histogram& latency, const char* operation)
+        : timer_(latency)
+        , span_(operation, "db") {}
+};
+
+// Steps a statement to the end, converting each row with read. When the request is traced,
+// the span also separates the time spent copying rows out of SQLite from the time spent in sqlite3_step.
+template <typename Row, typename Read>
+void collectRows(sqlite3_stmt* stmt, std::vector<Row>& rows, Read read) {
+    tracing::ScopedSpan span("step_rows", "db");
+    if (!span.active()) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            rows.push_back(read(stmt));
+        }
+        return;
+    }
+    std::int64_t copy_ns = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        auto start = tracing::Clock::now();
+        rows.push_back(read(stmt));
+        copy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(tracing::Clock::now() - start).count();
+    }
+    span.setRows(static_cast<std::int64_t>(rows.size()));
+    span.setCopyTime(copy_ns);
+}
+
+} // namespace
+
+DatabaseManager::DatabaseManager(const std::string& db_name, std::size_t pool_size, const DurabilityProfile& profile) 
     : db_name_(db_name)
-    , db_(nullptr) {}
+    , profile_(profile)
+    , pool_(std::make_unique<ConnectionPool>(db_name, pool_size))
+    , device_cache_(std::make_unique<LruCache<int, Device>>(0))
+    , location_cache_(std::make_unique<LruCache<int, Location>>(0))
+    , data_version_(0)
+    , explain_filter_queries_(false)
+    , explained_filter_masks_(0)
+    , snapshot_(nullptr)
+    , changes_(100000)
+    , closed_(false) {}
 
 DatabaseManager::~DatabaseManager() {
     close();
@@ -21,40 +118,92 @@ DatabaseManager::~DatabaseManager() {
 
 void DatabaseManager::init() {
     if (!open()) {
-        std::cerr << "Failed to open database: " << db_name_ << std::endl;
+        logging::error() << "Failed to open database: " << db_name_;
         return;
     }
-    if (!enableForeignKeys()) {
-        std::cerr << "Failed to enable foreign keys" << std::endl;
-        return;
+    {
+        auto connection = pool_->acquire();
+        if (!MigrationRunner(schemaMigrations()).run(connection->handle())) {
+            logging::error() << "Failed to migrate database schema";
+            return;
+        }
     }
-    if (!createTablesIfNeeded()) {
-        std::cerr << "Failed to create tables" << std::endl;
-        return;
+    logging::info() << "Database " << db_name_ << " opened with " << pool_->size() << " connections, "
+                    << profile_.describe();
+    if (profile_.synchronous == "OFF") {
+        logging::warn() << "synchronous=OFF: an OS crash or power loss can corrupt " << db_name_;
+    }
+    if (snapshot_ && !loadSnapshot()) {
+        logging::error() << "Failed to load the device snapshot, filter queries run on SQLite";
+        snapshot_.reset();
     }
 }
 
-bool DatabaseManager::open() { 
-    if (sqlite3_open(db_name_.c_str(), &db_) != SQLITE_OK) {
-        std::cerr << "Error opening database: " << sqlite3_errmsg(db_) << std::endl;
+bool DatabaseManager::loadSnapshot() {
+    auto started = std::chrono::steady_clock::now();
+    snapshot_->reset(getAllLocations());
+    if (!forEachDevice([this](const DeviceView& device) { snapshot_->insertDevice(device); })) {
         return false;
     }
+    SnapshotStats stats = snapshot_->stats();
+    logging::info() << "Device snapshot loaded: " << stats.rows << " devices in "
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count()
+                    << " ms";
     return true;
 }
 
+bool DatabaseManager::open() { 
+    return pool_->open([this](sqlite3* db) { return configureConnection(db); });
+}
+
 
 void DatabaseManager::close() {
-    if (db_) {
-        sqlite3_close(db_);
-        db_ = nullptr;
+    if (closed_.exchange(true)) {
+        return;
+    }
+    changes_.close();
+    StatementCacheStats stats = pool_->statementCacheStats();
+    if (stats.hits + stats.misses > 0) {
+        logging::info() << "Statement cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+                        << stats.size << " statements";
     }
+    for (const auto& [name, cache] : { std::make_pair("Device", deviceCacheStats()), std::make_pair("Location", locationCacheStats()) }) {
+        if (cache.hits + cache.misses > 0) {
+            logging::info() << name << " cache: " << cache.hits << " hits, " << cache.misses << " misses, "
+                            << cache.evictions << " evictions";
+        }
+    }
+    // Folds the WAL back into the database file and truncates it, so the next start has no log to replay
+    pool_->close([](sqlite3* db) {
+        int log = 0, checkpointed = 0;
+        if (sqlite3_wal_checkpoint_v2(db, nullptr, SQLITE_CHECKPOINT_TRUNCATE, &log, &checkpointed) != SQLITE_OK) {
+            logging::error() << "Error checkpointing the WAL: " << sqlite3_errmsg(db);
+            return;
+        }
+        if (log >= 0) {  // -1 when the database is not in WAL mode
+            logging::info() << "WAL checkpointed: " << checkpointed << " of " << log << " frames";
+        }
+    });
 }
 
-bool DatabaseManager::enableForeignKeys() {
+bool DatabaseManager::configureConnection(sqlite3* db) const {
+    if (!enableForeignKeys(db)) {
+        logging::error() << "Failed to enable foreign keys";
+        return false;
+    }
+    // Also sets the busy timeout, so concurrent writers on other pooled connections wait for the lock
+    if (!profile_.apply(db)) {
+        logging::error() << "Failed to apply durability profile: " << profile_.name;
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::enableForeignKeys(sqlite3* db) {
     char* errMsg;
     std::string fk_on = "PRAGMA foreign_keys = ON;";
-    if (sqlite3_exec(db_, fk_on.c_str(), NULL, 0, &errMsg) != SQLITE_OK) {
-        std::cerr << "Error setting foreign key pragma: " << errMsg << std::endl;
+    if (sqlite3_exec(db, fk_on.c_str(), NULL, 0, &errMsg) != SQLITE_OK) {
+        logging::error() << "Error setting foreign key pragma: " << errMsg;
         sqlite3_free(errMsg);
         return false;
     }
@@ -63,279 +212,652 @@ bool DatabaseManager::enableForeignKeys() {
 
 bool DatabaseManager::executeStatement(sqlite3_stmt* stmt) {
     if (sqlite3_step(stmt) != SQLITE_DONE) {
-        std::cerr << "Failed to execute statement: " << sqlite3_errmsg(db_) << std::endl;
-        sqlite3_finalize(stmt);
+        logging::error() << "Failed to execute statement: " << sqlite3_errmsg(sqlite3_db_handle(stmt));
         return false;
     }
-    sqlite3_finalize(stmt);
     return true;
 }
 
-bool DatabaseManager::createTablesIfNeeded() {
-    // SQL statement to create your tables
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS devices (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            name TEXT NOT NULL,
-            type TEXT NOT NULL,
-            serial_number TEXT UNIQUE NOT NULL,
-            creation_date TEXT NOT NULL,
-            location_id INTEGER,
-            FOREIGN KEY (location_id) REFERENCES locations(id) ON DELETE RESTRICT
-        );
-        CREATE TABLE IF NOT EXISTS locations (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            name TEXT NOT NULL,
-            type TEXT NOT NULL
-        );
-    )";
-
-    // Execute SQL to create tables
-    char* errorMessage;
-    if (sqlite3_exec(db_, sql, nullptr, nullptr, &errorMessage) != SQLITE_OK) {
-        std::cerr << "Error creating tables: " << errorMessage << std::endl;
-        sqlite3_free(errorMessage);
-        return false;
+Device DatabaseManager::readDevice(sqlite3_stmt* stmt) {
+    Device device;
+    device.id = sqlite3_column_int(stmt, 0);
+    device.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+    device.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+    device.serial_number = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+    device.creation_date = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+    device.location_id = sqlite3_column_int(stmt, 5);
+    return device;
+}
+
+Location DatabaseManager::readLocation(sqlite3_stmt* stmt) {
+    Location location;
+    location.id = sqlite3_column_int(stmt, 0);
+    location.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+    location.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+    return location;
+}
+
+void DatabaseManager::logQueryPlan(sqlite3* db, const std::string& label, const std::string& sql) {
+    std::string explain = "EXPLAIN QUERY PLAN " + sql;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, explain.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        logging::error() << "Failed to explain " << label << ": " << sqlite3_errmsg(db);
+        return;
     }
-    return true;
+    // Rows are (id, parent, notused, detail)
+    std::string plan = "Query plan of " + label + ": " + sql;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        plan += "\n    ";
+        plan += reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+    }
+    sqlite3_finalize(stmt);
+    logging::info() << plan;
 }
 
 bool DatabaseManager::addDevice(const Device& device) {
+    static metrics::Histogram& latency = operationLatency("addDevice");
+    OperationScope scope(latency, "addDevice");
     // SQL statement to insert a new device
     const char* sql = "INSERT INTO Devices (name, type, serial_number, creation_date, location_id) VALUES (?, ?, ?, ?, ?);";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+    auto connection = pool_->acquire();
+    if (!connection) {
         return false;
     }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::AddDevice, sql));
+    if (!stmt) {
+        return false;
+    }
+
+    sqlite3_bind_text(stmt.get(), 1, device.name.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, device.type.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, device.serial_number.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 4, device.creation_date.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt.get(), 5, device.location_id);
+
+    auto ordered = lockWrites();
+    if (!executeStatement(stmt.get())) {
+        return false;
+    }
+    int id = static_cast<int>(sqlite3_last_insert_rowid(connection->handle()));
+    if (snapshot_) {
+        snapshot_->insertDevice(DeviceView{ id, device.name, device.type, device.serial_number, device.creation_date,
+                                            device.location_id });
+    }
+    changes_.append(ChangeEntity::Device, id, ChangeOperation::Insert);
+    data_version_.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+BatchResult DatabaseManager::addDevices(const std::vector<Device>& devices) {
+    static metrics::Histogram& latency = operationLatency("addDevices");
+    OperationScope scope(latency, "addDevices");
+    // Same statement as addDevice
+    const char* sql = "INSERT INTO Devices (name, type, serial_number, creation_date, location_id) VALUES (?, ?, ?, ?, ?);";
+    BatchResult result = { false, 0, {} };
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return result;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::AddDevice, sql));
+    if (!stmt) {
+        return result;
+    }
+
+    // IMMEDIATE takes the write lock up front, so the batch cannot fail half-way with SQLITE_BUSY
+    auto ordered = lockWrites();
+    std::vector<Device> inserted;  // Applied to the snapshot once committed
+    std::vector<int> inserted_ids;  // Recorded in the change log once committed
+    inserted_ids.reserve(devices.size());
+    char* errMsg;
+    if (sqlite3_exec(connection->handle(), "BEGIN IMMEDIATE;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        logging::error() << "Failed to begin batch: " << errMsg;
+        sqlite3_free(errMsg);
+        return result;
+    }
 
-    sqlite3_bind_text(stmt, 1, device.name.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, device.type.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, device.serial_number.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, device.creation_date.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 5, device.location_id);
+    for (std::size_t i = 0; i < devices.size(); ++i) {
+        const Device& device = devices[i];
+        sqlite3_bind_text(stmt.get(), 1, device.name.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 2, device.type.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 3, device.serial_number.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 4, device.creation_date.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt.get(), 5, device.location_id);
+        // A constraint violation only rolls back this statement, the transaction stays open
+        if (sqlite3_step(stmt.get()) == SQLITE_DONE) {
+            result.inserted++;
+            inserted_ids.push_back(static_cast<int>(sqlite3_last_insert_rowid(connection->handle())));
+            if (snapshot_) {
+                inserted.push_back(device);
+                inserted.back().id = inserted_ids.back();
+            }
+        } else {
+            result.errors.push_back({ i, sqlite3_errmsg(connection->handle()) });
+        }
+        sqlite3_reset(stmt.get());
+    }
 
-    return executeStatement(stmt);
+    if (sqlite3_exec(connection->handle(), "COMMIT;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        logging::error() << "Failed to commit batch: " << errMsg;
+        sqlite3_free(errMsg);
+        sqlite3_exec(connection->handle(), "ROLLBACK;", nullptr, nullptr, nullptr);
+        result.inserted = 0;
+        return result;
+    }
+    result.committed = true;
+    if (snapshot_) {
+        snapshot_->insertDevices(inserted);
+    }
+    changes_.append(ChangeEntity::Device, inserted_ids, ChangeOperation::Insert);
+    if (result.inserted > 0) {
+        data_version_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    return result;
 }
 
 std::optional<Device> DatabaseManager::getDevice(int id) {
+    static metrics::Histogram& latency = operationLatency("getDevice");
+    OperationScope scope(latency, "getDevice");
     // SQL statement to get a device
     const char* sql = "SELECT * FROM Devices WHERE id = ?;";
-    sqlite3_stmt* stmt;
-    Device device;
+    if (auto cached = device_cache_->get(id)) {
+        return cached;
+    }
+    std::uint64_t generation = device_cache_->generation(id);
 
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return std::nullopt;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::GetDevice, sql));
+    if (!stmt) {
         return std::nullopt;
     }
 
-    sqlite3_bind_int(stmt, 1, id);
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        device.id = sqlite3_column_int(stmt, 0);
-        device.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        device.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        device.serial_number = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        device.creation_date = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        device.location_id = sqlite3_column_int(stmt, 5);
-    } else {
-        std::cerr << "No device found with id: " << id << std::endl;
-        sqlite3_finalize(stmt);
+    sqlite3_bind_int(stmt.get(), 1, id);
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+        logging::debug() << "No device found with id: " << id;
         return std::nullopt;
     }
 
-    sqlite3_finalize(stmt);
+    Device device = readDevice(stmt.get());
+    device_cache_->put(id, device, generation);
     return device;
 }
 
 std::vector<Device> DatabaseManager::getAllDevices() {
+    static metrics::Histogram& latency = operationLatency("getAllDevices");
+    OperationScope scope(latency, "getAllDevices");
     // SQL statement to get all devices
     const char* sql = "SELECT * FROM Devices;";
-    sqlite3_stmt* stmt;
     std::vector<Device> devices;
-
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return devices;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::GetAllDevices, sql));
+    if (!stmt) {
         return devices;
     }
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Device device;
-        device.id = sqlite3_column_int(stmt, 0);
-        device.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        device.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        device.serial_number = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        device.creation_date = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        device.location_id = sqlite3_column_int(stmt, 5);
-        devices.push_back(device);
+    collectRows(stmt.get(), devices, readDevice);
+
+    return devices;
+}
+
+bool DatabaseManager::forEachDevice(const std::function<void(const DeviceView&)>& visitor) {
+    static metrics::Histogram& latency = operationLatency("forEachDevice");
+    OperationScope scope(latency, "forEachDevice");
+    // Same statement as getAllDevices, stepped row by row instead of collected
+    const char* sql = "SELECT * FROM Devices;";
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return false;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::GetAllDevices, sql));
+    if (!stmt) {
+        return false;
     }
 
-    sqlite3_finalize(stmt);
+    auto column = [&stmt](int index) {
+        // sqlite3_column_text must run before sqlite3_column_bytes for the length to match the text
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), index));
+        return std::string_view(text, sqlite3_column_bytes(stmt.get(), index));
+    };
+    int rc;
+    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+        std::string_view name = column(1);
+        std::string_view type = column(2);
+        std::string_view serial_number = column(3);
+        std::string_view creation_date = column(4);
+        visitor(DeviceView{ sqlite3_column_int(stmt.get(), 0), name, type, serial_number, creation_date,
+                            sqlite3_column_int(stmt.get(), 5) });
+    }
+    if (rc != SQLITE_DONE) {
+        logging::error() << "Failed to export devices: " << sqlite3_errmsg(connection->handle());
+        return false;
+    }
+    return true;
+}
+
+std::vector<Device> DatabaseManager::getDevicesPage(int after_id, int limit) {
+    static metrics::Histogram& latency = operationLatency("getDevicesPage");
+    OperationScope scope(latency, "getDevicesPage");
+    // SQL statement to get one page of devices, seeking on the primary key
+    const char* sql = "SELECT * FROM Devices WHERE id > ? ORDER BY id LIMIT ?;";
+    std::vector<Device> devices;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return devices;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::GetDevicesPage, sql));
+    if (!stmt) {
+        return devices;
+    }
+
+    sqlite3_bind_int(stmt.get(), 1, after_id);
+    sqlite3_bind_int(stmt.get(), 2, limit);
+    devices.reserve(limit);
+    collectRows(stmt.get(), devices, readDevice);
+
     return devices;
 }
 
 bool DatabaseManager::updateDevice(const Device& device) {
+    static metrics::Histogram& latency = operationLatency("updateDevice");
+    OperationScope scope(latency, "updateDevice");
     // SQL statement to update a device
     const char* sql = "UPDATE Devices SET name = ?, type = ?, serial_number = ?, creation_date = ?, location_id = ? WHERE id = ?;";
-    sqlite3_stmt* stmt;
-
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return false;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::UpdateDevice, sql));
+    if (!stmt) {
         return false;
     }
 
-    sqlite3_bind_text(stmt, 1, device.name.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, device.type.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, device.serial_number.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, device.creation_date.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 5, device.location_id);
-    sqlite3_bind_int(stmt, 5, device.id);
+    sqlite3_bind_text(stmt.get(), 1, device.name.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, device.type.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, device.serial_number.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 4, device.creation_date.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt.get(), 5, device.location_id);
+    sqlite3_bind_int(stmt.get(), 6, device.id);
 
-    return executeStatement(stmt);
+    auto ordered = lockWrites();
+    if (!executeStatement(stmt.get())) {
+        return false;
+    }
+    if (sqlite3_changes(connection->handle()) > 0) {
+        if (snapshot_) {
+            snapshot_->updateDevice(device);
+        }
+        changes_.append(ChangeEntity::Device, device.id, ChangeOperation::Update);
+        device_cache_->invalidate(device.id);
+        data_version_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    return true;
 }
 
 bool DatabaseManager::deleteDevice(int id) {
+    static metrics::Histogram& latency = operationLatency("deleteDevice");
+    OperationScope scope(latency, "deleteDevice");
     // SQL statement to delete a device
     const char* sql = "DELETE FROM Devices WHERE id = ?;";
-    sqlite3_stmt* stmt;
-
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return false;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::DeleteDevice, sql));
+    if (!stmt) {
         return false;
     }
 
-    sqlite3_bind_int(stmt, 1, id);
+    sqlite3_bind_int(stmt.get(), 1, id);
 
-    return executeStatement(stmt);
+    auto ordered = lockWrites();
+    if (!executeStatement(stmt.get())) {
+        return false;
+    }
+    if (sqlite3_changes(connection->handle()) > 0) {
+        if (snapshot_) {
+            snapshot_->deleteDevice(id);
+        }
+        changes_.append(ChangeEntity::Device, id, ChangeOperation::Delete);
+        device_cache_->invalidate(id);
+        data_version_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    return true;
 }
 
-std::vector<Device> DatabaseManager::getDevicesWithFilters(const std::string& name, const std::string& type, const std::string& serial_number, const std::string& creation_date_start, const std::string& creation_date_end, const std::string& location) {
-    // SQL statement to get all devices with filters
-    std::string sql = "SELECT devices.* FROM devices INNER JOIN locations ON devices.location_id = locations.id WHERE 1 = 1";
-    std::vector<Device> devices;
-    if (!name.empty()) sql += " AND devices.name = '" + name + "'";
-    if (!type.empty()) sql += " AND devices.type = '" + type + "'";
-    if (!serial_number.empty()) sql += " AND devices.serial_number = '" + serial_number + "'";
-    if (!creation_date_start.empty()) sql += " AND devices.creation_date >= '" + creation_date_start + "'";
-    if (!creation_date_end.empty()) sql += " AND devices.creation_date <= '" + creation_date_end + "'";
-    if (!location.empty()) sql += " AND locations.name = '" + location + "'";
+std::vector<Device> DatabaseManager::getDevicesWithFilters(const std::string& name, const std::string& type, const std::string& serial_number, const std::string& creation_date_start, const std::string& creation_date_end, const std::string& location, int after_id, int limit) {
+    static metrics::Histogram& latency = operationLatency("getDevicesWithFilters");
+    OperationScope scope(latency, "getDevicesWithFilters");
+    // Each combination of filters is its own cached statement, identified by a bit mask
+    const std::string* values[] = { &name, &type, &serial_number, &creation_date_start, &creation_date_end, &location };
+    std::uint32_t mask = 0;
+    for (std::uint32_t i = 0; i < 6; ++i) {
+        if (!values[i]->empty()) mask |= 1u << i;
+    }
 
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "SQL error: " << sqlite3_errmsg(db_) << std::endl;
+    std::vector<Device> devices;
+    if (snapshot_ && snapshot_->query(name, type, serial_number, creation_date_start, creation_date_end, location,
+                                      after_id, limit, devices)) {
+        return devices;
+    }
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return devices;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::FilterDevices, mask, [mask] { return buildFilterSql(mask); }));
+    if (!stmt) {
         return devices;
     }
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Device device;
-        device.id = sqlite3_column_int(stmt, 0);
-        device.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        device.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        device.serial_number = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        device.creation_date = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        device.location_id = sqlite3_column_int(stmt, 5);
-        devices.push_back(device);
+    if (explain_filter_queries_) {
+        std::uint64_t bit = std::uint64_t(1) << mask;
+        if (!(explained_filter_masks_.fetch_or(bit) & bit)) {
+            logQueryPlan(connection->handle(), "filter mask " + std::to_string(mask), buildFilterSql(mask));
+        }
     }
 
-    sqlite3_finalize(stmt);
+    int index = 1;
+    for (const std::string* value : values) {
+        if (value != &location && !value->empty()) sqlite3_bind_text(stmt.get(), index++, value->c_str(), -1, SQLITE_STATIC);
+    }
+    if (location.empty()) {
+        sqlite3_bind_int(stmt.get(), index++, after_id);
+        sqlite3_bind_int(stmt.get(), index, limit);
+        collectRows(stmt.get(), devices, readDevice);
+        return devices;
+    }
+
+    // Each location with that name is read as its own id-ordered page; names are nearly always unique,
+    // otherwise the pages are merged
+    std::vector<int> location_ids = findLocationIds(*connection, location);
+    for (int location_id : location_ids) {
+        sqlite3_bind_int(stmt.get(), index, location_id);
+        sqlite3_bind_int(stmt.get(), index + 1, after_id);
+        sqlite3_bind_int(stmt.get(), index + 2, limit);
+        collectRows(stmt.get(), devices, readDevice);
+        sqlite3_reset(stmt.get());
+    }
+    if (location_ids.size() > 1) {
+        std::sort(devices.begin(), devices.end(), [](const Device& a, const Device& b) { return a.id < b.id; });
+        if (limit >= 0 && devices.size() > static_cast<std::size_t>(limit)) {
+            devices.resize(static_cast<std::size_t>(limit));
+        }
+    }
     return devices;
 }
 
+std::vector<int> DatabaseManager::findLocationIds(Connection& connection, const std::string& name) {
+    std::vector<int> ids;
+    const char* sql = "SELECT id FROM locations WHERE name = ? ORDER BY id;";
+    ScopedStatement stmt(connection.statements().acquire(StatementKind::FindLocationIds, sql));
+    if (!stmt) {
+        return ids;
+    }
+    sqlite3_bind_text(stmt.get(), 1, name.c_str(), -1, SQLITE_STATIC);
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        ids.push_back(sqlite3_column_int(stmt.get(), 0));
+    }
+    return ids;
+}
+
+std::optional<std::vector<DeviceGroup>> DatabaseManager::countDevices(DeviceGrouping grouping) {
+    static metrics::Histogram& latency = operationLatency("countDevices");
+    OperationScope scope(latency, "countDevices");
+    // Each grouping is its own cached statement
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return std::nullopt;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::CountDevices, static_cast<std::uint32_t>(grouping),
+                                                          [grouping] { return std::string(countDevicesSql(grouping)); }));
+    if (!stmt) {
+        return std::nullopt;
+    }
+
+    std::vector<DeviceGroup> groups;
+    int rc;
+    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0));
+        std::string_view key(text, sqlite3_column_bytes(stmt.get(), 0));
+        if (grouping == DeviceGrouping::CreationMonth) {
+            // Dates arrive in order, so the days of a month are adjacent
+            key = key.substr(0, 7);
+            if (!groups.empty() && groups.back().key == key) {
+                groups.back().count += sqlite3_column_int64(stmt.get(), 2);
+                continue;
+            }
+        }
+        groups.push_back({ std::string(key), sqlite3_column_int(stmt.get(), 1), sqlite3_column_int64(stmt.get(), 2) });
+    }
+    if (rc != SQLITE_DONE) {
+        logging::error() << "Failed to count devices: " << sqlite3_errmsg(connection->handle());
+        return std::nullopt;
+    }
+    return groups;
+}
+
 bool DatabaseManager::addLocation(const Location& location) {
+    static metrics::Histogram& latency = operationLatency("addLocation");
+    OperationScope scope(latency, "addLocation");
     // SQL statement to insert a new location
     const char* sql = "INSERT INTO Locations (name, type) VALUES (?, ?);";
-    sqlite3_stmt* stmt;
-
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return false;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::AddLocation, sql));
+    if (!stmt) {
         return false;
     }
 
-    sqlite3_bind_text(stmt, 1, location.name.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, location.type.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 1, location.name.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, location.type.c_str(), -1, SQLITE_STATIC);
 
-    return executeStatement(stmt);
+    auto ordered = lockWrites();
+    if (!executeStatement(stmt.get())) {
+        return false;
+    }
+    int id = static_cast<int>(sqlite3_last_insert_rowid(connection->handle()));
+    if (snapshot_) {
+        snapshot_->putLocation(id, location.name);
+    }
+    changes_.append(ChangeEntity::Location, id, ChangeOperation::Insert);
+    data_version_.fetch_add(1, std::memory_order_acq_rel);
+    return true;
 }
 
 std::optional<Location> DatabaseManager::getLocation(int id) {
+    static metrics::Histogram& latency = operationLatency("getLocation");
+    OperationScope scope(latency, "getLocation");
     // SQL statement to get a location
     const char* sql = "SELECT * FROM Locations WHERE id = ?;";
-    sqlite3_stmt* stmt;
-    Location location;
+    if (auto cached = location_cache_->get(id)) {
+        return cached;
+    }
+    std::uint64_t generation = location_cache_->generation(id);
 
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return std::nullopt;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::GetLocation, sql));
+    if (!stmt) {
         return std::nullopt;
     }
 
-    sqlite3_bind_int(stmt, 1, id);
-
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        location.id = sqlite3_column_int(stmt, 0);
-        location.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        location.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-    } else {
-        std::cerr << "No location found with id: " << id << std::endl;
-        sqlite3_finalize(stmt);
+    sqlite3_bind_int(stmt.get(), 1, id);
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+        logging::debug() << "No location found with id: " << id;
         return std::nullopt;
     }
 
-    sqlite3_finalize(stmt);
+    Location location = readLocation(stmt.get());
+    location_cache_->put(id, location, generation);
     return location;
 }
 
 std::vector<Location> DatabaseManager::getAllLocations() {
+    static metrics::Histogram& latency = operationLatency("getAllLocations");
+    OperationScope scope(latency, "getAllLocations");
     // SQL statement to get all locations
     const char* sql = "SELECT * FROM Locations;";
-    sqlite3_stmt* stmt;
     std::vector<Location> locations;
-
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return locations;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::GetAllLocations, sql));
+    if (!stmt) {
         return locations;
     }
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Location location;
-        location.id = sqlite3_column_int(stmt, 0);
-        location.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        location.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        locations.push_back(location);
+    collectRows(stmt.get(), locations, readLocation);
+
+    return locations;
+}
+
+std::vector<Location> DatabaseManager::getLocationsPage(int after_id, int limit) {
+    static metrics::Histogram& latency = operationLatency("getLocationsPage");
+    OperationScope scope(latency, "getLocationsPage");
+    // SQL statement to get one page of locations, seeking on the primary key
+    const char* sql = "SELECT * FROM Locations WHERE id > ? ORDER BY id LIMIT ?;";
+    std::vector<Location> locations;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return locations;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::GetLocationsPage, sql));
+    if (!stmt) {
+        return locations;
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_bind_int(stmt.get(), 1, after_id);
+    sqlite3_bind_int(stmt.get(), 2, limit);
+    locations.reserve(limit);
+    collectRows(stmt.get(), locations, readLocation);
+
     return locations;
 }
 
 bool DatabaseManager::updateLocation(const Location& location) {
+    static metrics::Histogram& latency = operationLatency("updateLocation");
+    OperationScope scope(latency, "updateLocation");
     // SQL statement to update a location
     const char* sql = "UPDATE Locations SET name = ?, type = ? WHERE id = ?;";
-    sqlite3_stmt* stmt;
-
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return false;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::UpdateLocation, sql));
+    if (!stmt) {
         return false;
     }
 
-    sqlite3_bind_text(stmt, 1, location.name.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, location.type.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 3, location.id);
+    sqlite3_bind_text(stmt.get(), 1, location.name.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, location.type.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt.get(), 3, location.id);
 
-    return executeStatement(stmt);
+    auto ordered = lockWrites();
+    if (!executeStatement(stmt.get())) {
+        return false;
+    }
+    if (sqlite3_changes(connection->handle()) > 0) {
+        if (snapshot_) {
+            snapshot_->putLocation(location.id, location.name);
+        }
+        changes_.append(ChangeEntity::Location, location.id, ChangeOperation::Update);
+        location_cache_->invalidate(location.id);
+        data_version_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    return true;
 }
 
 bool DatabaseManager::deleteLocation(int id) {
+    static metrics::Histogram& latency = operationLatency("deleteLocation");
+    OperationScope scope(latency, "deleteLocation");
     // SQL statement to delete a location
     const char* sql = "DELETE FROM Locations WHERE id = ?;";
-    sqlite3_stmt* stmt;
+    auto connection = pool_->acquire();
+    if (!connection) {
+        return false;
+    }
+    ScopedStatement stmt(connection->statements().acquire(StatementKind::DeleteLocation, sql));
+    if (!stmt) {
+        return false;
+    }
 
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+    sqlite3_bind_int(stmt.get(), 1, id);
+
+    auto ordered = lockWrites();
+    if (!executeStatement(stmt.get())) {
         return false;
     }
+    if (sqlite3_changes(connection->handle()) > 0) {
+        if (snapshot_) {
+            snapshot_->deleteLocation(id);
+        }
+        changes_.append(ChangeEntity::Location, id, ChangeOperation::Delete);
+        location_cache_->invalidate(id);
+        data_version_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    return true;
+}
+
+StatementCacheStats DatabaseManager::statementCacheStats() const {
+    return pool_->statementCacheStats();
+}
+
+CacheStats DatabaseManager::deviceCacheStats() const {
+    return device_cache_->stats();
+}
+
+CacheStats DatabaseManager::locationCacheStats() const {
+    return location_cache_->stats();
+}
+
+void DatabaseManager::setCacheCapacities(std::size_t device_capacity, std::size_t location_capacity) {
+    device_cache_ = std::make_unique<LruCache<int, Device>>(device_capacity);
+    location_cache_ = std::make_unique<LruCache<int, Location>>(location_capacity);
+}
+
+void DatabaseManager::setExplainFilterQueries(bool enabled) {
+    explain_filter_queries_ = enabled;
+}
 
-    sqlite3_bind_int(stmt, 1, id);
+void DatabaseManager::setDeviceSnapshot(bool enabled) {
+    snapshot_ = enabled ? std::make_unique<DeviceSnapshot>() : nullptr;
+}
+
+SnapshotStats DatabaseManager::deviceSnapshotStats() const {
+    return snapshot_ ? snapshot_->stats() : SnapshotStats{ 0, 0, 0, 0 };
+}
+
+std::optional<std::vector<Change>> DatabaseManager::getChanges(std::uint64_t since, std::size_t limit) const {
+    std::vector<Change> changes;
+    if (changes_.read(since, limit, changes) == ChangeRead::Expired) {
+        return std::nullopt;
+    }
+    return changes;
+}
+
+bool DatabaseManager::waitForChanges(std::uint64_t since, std::chrono::milliseconds timeout) const {
+    return changes_.waitFor(since, timeout);
+}
+
+std::uint64_t DatabaseManager::lastChange() const {
+    return changes_.lastSeq();
+}
+
+void DatabaseManager::closeChanges() {
+    changes_.close();
+}
 
-    return executeStatement(stmt);
+void DatabaseManager::setChangeLogCapacity(std::size_t capacity) {
+    changes_.setCapacity(capacity);
 }
 
 } // namespace database
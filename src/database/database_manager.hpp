@@ -10,18 +10,60 @@
 #define DATABASE_MANAGER_HPP
 
 #include <sqlite3.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <optional>
 #include <memory>
 #include "../utilities/metadata.hpp"
+#include "change_log.hpp"
+#include "connection_pool.hpp"
+#include "device_snapshot.hpp"
+#include "durability_profile.hpp"
+#include "lru_cache.hpp"
 
 namespace database {
 
+/**
+ * @brief The outcome of a batch insert. Rows that fail are reported individually and do not abort the batch.
+ */
+struct BatchResult {
+    struct RowError {
+        std::size_t index;  // Position of the row in the batch
+        std::string error;
+    };
+
+    bool committed;         // False if the transaction itself could not be opened or committed
+    std::size_t inserted;
+    std::vector<RowError> errors;
+};
+
+/**
+ * @brief The column countDevices groups devices by.
+ */
+enum class DeviceGrouping : std::uint32_t {
+    Type,
+    Location,
+    CreationMonth,
+};
+
 class DatabaseManager {
 private:
-    sqlite3* db_;
     std::string db_name_;
+    DurabilityProfile profile_;
+    std::unique_ptr<ConnectionPool> pool_;
+    std::unique_ptr<LruCache<int, Device>> device_cache_;
+    std::unique_ptr<LruCache<int, Location>> location_cache_;
+    std::atomic<std::uint64_t> data_version_;  // Bumped after every write that changed a row
+    bool explain_filter_queries_;
+    std::atomic<std::uint64_t> explained_filter_masks_;  // One bit per getDevicesWithFilters variant already explained
+    std::unique_ptr<DeviceSnapshot> snapshot_;           // Answers getDevicesWithFilters when enabled, null otherwise
+    std::mutex write_mutex_;                             // Orders the writes, see lockWrites()
+    ChangeLog changes_;                                  // The writes applied, for getChanges
+    std::atomic<bool> closed_;                           // Set by the first close(), later calls do nothing
 
     /**
      * @brief A member function that open the database.
@@ -30,31 +72,80 @@ private:
     bool open();
 
     /**
-     * @brief A member function that creates the tables if they do not exist.
-     * @return True if the tables are created successfully, false otherwise.
+     * @brief A member function that applies the per-connection settings to a newly opened connection.
+     * @param db The connection to be configured.
+     * @return True if the connection is configured successfully, false otherwise.
      */
-    bool createTablesIfNeeded();
+    bool configureConnection(sqlite3* db) const;
+
+    /**
+     * @brief A member function that loads the device snapshot from the database.
+     * @return True if the snapshot is loaded, false if the tables cannot be read.
+     */
+    bool loadSnapshot();
+
+    /**
+     * @brief A member function that takes the lock ordering the writes. Every write holds it from before its
+     *        statement runs until it is applied to the device snapshot and recorded in the change log, so both
+     *        see the writes in the order SQLite committed them. SQLite runs one write at a time anyway.
+     * @return The lock.
+     */
+    std::unique_lock<std::mutex> lockWrites() { return std::unique_lock<std::mutex>(write_mutex_); }
+
+    /**
+     * @brief A member function that logs the EXPLAIN QUERY PLAN output of the given statement.
+     * @param db The connection the plan is computed on.
+     * @param label A short description of the statement for the log.
+     * @param sql The SQL text of the statement.
+     */
+    static void logQueryPlan(sqlite3* db, const std::string& label, const std::string& sql);
 
     /**
      * @brief A member function that enables foreign keys.
+     * @param db The connection the foreign keys are enabled on.
      * @return True if the foreign keys are enabled successfully, false otherwise.
      */
-    bool enableForeignKeys();
+    static bool enableForeignKeys(sqlite3* db);
 
     /**
      * @brief A member function that executes the given statement.
      * @param stmt The statement to be executed.
      * @return True if the statement is executed successfully, false otherwise.
      */
-    bool executeStatement(sqlite3_stmt* stmt);
+    static bool executeStatement(sqlite3_stmt* stmt);
+
+    /**
+     * @brief A member function that reads a device from the current row of the given statement.
+     * @param stmt The statement positioned on a devices row.
+     * @return The device read from the row.
+     */
+    static Device readDevice(sqlite3_stmt* stmt);
+
+    /**
+     * @brief A member function that reads a location from the current row of the given statement.
+     * @param stmt The statement positioned on a locations row.
+     * @return The location read from the row.
+     */
+    static Location readLocation(sqlite3_stmt* stmt);
+
+    /**
+     * @brief A member function that returns the ids of the locations with the given name.
+     * @param connection The connection the lookup runs on.
+     * @param name The name of the locations.
+     * @return The ids in ascending order, empty if there is no such location or the lookup fails.
+     */
+    static std::vector<int> findLocationIds(Connection& connection, const std::string& name);
 
 public:
 
     /**
      * @brief A constructor for the DatabaseManager class.
      * @param db_name The name of the database.
+     * @param pool_size The number of connections kept open, one per concurrent caller.
+     * @param profile The durability/performance settings applied to every connection.
      */
-    DatabaseManager(const std::string& db_name);
+    DatabaseManager(const std::string& db_name, std::size_t pool_size = 1,
+                    const DurabilityProfile& profile = DurabilityProfile::balanced());
 
     /**
      * @brief A destructor for the DatabaseManager class.
@@ -63,13 +154,16 @@ public:
 
     /**
      * @brief A member function that initializes the database.
-     *        It opens the database, creates the tables if they do not exist and enables foreign keys.
+     *        It opens the connection pool, enables foreign keys and applies the durability profile on every connection
+     *        and migrates the schema to the latest version.
      * @return True if the database is initialized successfully, false otherwise.
      */
     void init();
 
     /**
-     * @brief A member function that closes the database.
+     * @brief A member function that closes the database: wakes the callers waiting for changes, waits for
+     *        the operations in progress, checkpoints and truncates the WAL, then closes every connection.
+     *        Only the first call does so, e.g. a shutdown followed by the destructor.
      */
     void close();
 
@@ -80,6 +174,15 @@ public:
      */
     bool addDevice(const Device& device);
 
+    /**
+     * @brief A member function that adds many devices in a single transaction, reusing one prepared statement.
+     *        A row that violates a constraint (e.g. a duplicate serial number or an unknown location) is skipped
+     *        and reported, the other rows are still inserted.
+     * @param devices The devices to be added.
+     * @return The number of inserted rows and the error of every rejected row.
+     */
+    BatchResult addDevices(const std::vector<Device>& devices);
+
     /**
      * @brief A member function that updates a device in the database.
      * @param device The device to be updated.
@@ -95,7 +198,7 @@ public:
     bool deleteDevice(int id);
 
     /**
-     * @brief A member function that gets a device from the database.
+     * @brief A member function that gets a device from the cache, or from the database on a miss.
      * @param id The id of the device to be retrieved.
      * @return The device if it is retrieved successfully, an empty optional otherwise.
      */
@@ -107,22 +210,51 @@ public:
      */
     std::vector<Device> getAllDevices();
 
+    /**
+     * @brief A member function that gets one page of devices, ordered by id.
+     * @param after_id The id of the last device of the previous page, 0 for the first page.
+     * @param limit The maximum number of devices in the page.
+     * @return A vector of at most limit devices whose id is greater than after_id.
+     */
+    std::vector<Device> getDevicesPage(int after_id, int limit);
+
+    /**
+     * @brief A member function that visits every device in id order without materializing the table.
+     *        The view handed to the visitor points into SQLite's row buffer and is only valid during the call.
+     * @param visitor The function called for each device row.
+     * @return True if every row is visited, false if the query fails.
+     */
+    bool forEachDevice(const std::function<void(const DeviceView&)>& visitor);
+
     /**
      * @brief A member function that gets all devices from the database with the given filters.
+     *        The device snapshot answers it when enabled, see setDeviceSnapshot.
      * @param name The name of the device.
      * @param type The type of the device.
      * @param serial_number The serial number of the device.
      * @param creation_date_start The start date of the creation date of the device.
      * @param creation_date_end The end date of the creation date of the device.
      * @param location The location of the device.
-     * @return A vector of devices if they are retrieved successfully, an empty vector otherwise.
+     * @param after_id Only devices with a greater id are returned, 0 to start from the first device.
+     * @param limit The maximum number of devices returned, -1 for no limit.
+     * @return A vector of devices ordered by id if they are retrieved successfully, an empty vector otherwise.
      */
     std::vector<Device> getDevicesWithFilters(const std::string& name, const std::string& type, 
                                               const std::string& serial_number, const std::string& creation_date_start, 
-                                              const std::string& creation_date_end, const std::string& location);
+                                              const std::string& creation_date_end, const std::string& location,
+                                              int after_id = 0, int limit = -1);
     
     /**
-     * @brief A member function that gets a location from the database.
+     * @brief A member function that counts the devices per type, location or creation month with a GROUP BY,
+     *        so callers get the totals without reading every row.
+     * @param grouping The column the devices are grouped by. Devices are grouped by location id and only
+     *        counted if the location exists; the creation month is the first seven characters of the date.
+     * @return The groups ordered by key, or by location id, if they are counted successfully, an empty optional otherwise.
+     */
+    std::optional<std::vector<DeviceGroup>> countDevices(DeviceGrouping grouping);
+
+    /**
+     * @brief A member function that gets a location from the cache, or from the database on a miss.
      * @param id The id of the location to be retrieved.
      * @return The location if it is retrieved successfully, an empty optional otherwise.
      */
@@ -134,6 +266,14 @@ public:
      */
     std::vector<Location> getAllLocations();
 
+    /**
+     * @brief A member function that gets one page of locations, ordered by id.
+     * @param after_id The id of the last location of the previous page, 0 for the first page.
+     * @param limit The maximum number of locations in the page.
+     * @return A vector of at most limit locations whose id is greater than after_id.
+     */
+    std::vector<Location> getLocationsPage(int after_id, int limit);
+
     /**
      * @brief A member function that adds a location to the database.
      * @param location The location to be added.
@@ -154,6 +294,96 @@ public:
      * @return True if the location is deleted successfully, false otherwise.
      */
     bool deleteLocation(int id);
+
+    /**
+     * @brief A member function that returns the hit/miss counters of the prepared statement cache.
+     * @return The current counters.
+     */
+    StatementCacheStats statementCacheStats() const;
+
+    /**
+     * @brief A member function that returns the data version, which every write through this DatabaseManager that
+     *        changed a row increments. Anything derived from the data stays valid while the version is unchanged.
+     * @return The current data version.
+     */
+    std::uint64_t dataVersion() const { return data_version_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief A member function that returns the counters of the getDevice read-through cache.
+     * @return The current counters.
+     */
+    CacheStats deviceCacheStats() const;
+
+    /**
+     * @brief A member function that returns the counters of the getLocation read-through cache.
+     * @return The current counters.
+     */
+    CacheStats locationCacheStats() const;
+
+    /**
+     * @brief A member function that resizes the read-through caches of getDevice and getLocation, dropping their contents.
+     *        Must be called before the database is used concurrently.
+     * @param device_capacity The maximum number of cached devices, 0 disables the cache.
+     * @param location_capacity The maximum number of cached locations, 0 disables the cache.
+     */
+    void setCacheCapacities(std::size_t device_capacity, std::size_t location_capacity);
+
+    /**
+     * @brief A member function that enables logging the query plan of each getDevicesWithFilters variant
+     *        the first time it is used, to check that the filter indexes are picked up.
+     * @param enabled True to log the query plans, false otherwise.
+     */
+    void setExplainFilterQueries(bool enabled);
+
+    /**
+     * @brief A member function that enables the in-memory columnar snapshot of the devices table, which then answers
+     *        getDevicesWithFilters. It is loaded by init() and kept up to date by the write paths, so it must be
+     *        enabled before init() and no other process may write to the database.
+     * @param enabled True to keep the snapshot, false to run every filter query on SQLite.
+     */
+    void setDeviceSnapshot(bool enabled);
+
+    /**
+     * @brief A member function that returns the counters of the device snapshot.
+     * @return The current counters, all zero if the snapshot is disabled.
+     */
+    SnapshotStats deviceSnapshotStats() const;
+
+    /**
+     * @brief A member function that returns the writes applied after a cursor of the change log.
+     * @param since The sequence number of the last change the caller has seen.
+     * @param limit The maximum number of changes returned.
+     * @return The changes after since, oldest first, or std::nullopt if some of them are no longer retained
+     *         or since was not issued by this process, in which case the caller must re-read the tables.
+     */
+    std::optional<std::vector<Change>> getChanges(std::uint64_t since, std::size_t limit) const;
+
+    /**
+     * @brief A member function that waits until a write is applied after a cursor of the change log.
+     * @param since The sequence number of the last change the caller has seen.
+     * @param timeout The longest wait.
+     * @return True if a change after since is available, false on timeout or once closeChanges() is called.
+     */
+    bool waitForChanges(std::uint64_t since, std::chrono::milliseconds timeout) const;
+
+    /**
+     * @brief A member function that returns the sequence number of the newest change, from which a caller
+     *        that has just read the tables can follow the changes.
+     * @return The sequence number.
+     */
+    std::uint64_t lastChange() const;
+
+    /**
+     * @brief A member function that wakes the callers waiting in waitForChanges and makes later waits return
+     *        immediately, so a shutdown does not wait for them.
+     */
+    void closeChanges();
+
+    /**
+     * @brief A member function that changes the number of writes the change log retains.
+     * @param capacity The number of changes retained, at least 1.
+     */
+    void setChangeLogCapacity(std::size_t capacity);
 };
 
 } // namespace database
@@ -0,0 +1,213 @@
+/**
+ * @file    device_snapshot.hpp
+ * @brief   This file contains the declaration of the DeviceSnapshot class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef DEVICE_SNAPSHOT_HPP
+#define DEVICE_SNAPSHOT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../utilities/metadata.hpp"
+
+namespace database {
+
+/**
+ * @brief A snapshot of the counters and sizes of a DeviceSnapshot.
+ */
+struct SnapshotStats {
+    std::uint64_t hits;       // Filter queries answered by the snapshot
+    std::uint64_t fallbacks;  // Filter queries left to SQLite
+    std::size_t rows;         // Live devices
+    std::size_t tombstones;   // Deleted devices not compacted yet
+};
+
+/**
+ * @brief An in-memory, column-oriented copy of the devices table and the location names, which answers
+ *        getDevicesWithFilters with scans over contiguous columns instead of SQL. SQLite stays the source of truth:
+ *        the snapshot is loaded at startup and then kept up to date by the DatabaseManager write paths, so it assumes
+ *        no other process writes to the database.
+ *
+ *        Names, types and serial numbers are dictionary encoded into 32-bit codes and creation dates are stored
+ *        as yyyymmdd integers, so every filter is an integer comparison. Rows are kept in id order; deleted rows
+ *        are tombstoned and compacted away once they make up a quarter of the table.
+ *
+ *        The DatabaseManager applies each write while still holding the lock ordering its writes, so the snapshot
+ *        sees them in the order SQLite committed them. Queries only share a reader lock with those applies.
+ */
+class DeviceSnapshot {
+private:
+    /**
+     * @brief Maps the distinct values of a column to dense codes. Codes are never reused, so a value whose
+     *        last row is gone stays in the dictionary until the next compaction rebuilds it.
+     */
+    class Dictionary {
+    private:
+        std::deque<std::string> values_;  // Indexed by code; a deque keeps the strings the keys view in place
+        std::unordered_map<std::string_view, std::uint32_t> codes_;
+
+    public:
+        std::uint32_t encode(std::string_view value);
+        bool find(std::string_view value, std::uint32_t& code) const;
+        const std::string& decode(std::uint32_t code) const { return values_[code]; }
+        std::size_t size() const { return values_.size(); }
+        void clear();
+    };
+
+    static constexpr std::int32_t kIrregularDate = -1;  // The date is not yyyy-mm-dd, see irregular_dates_
+    static constexpr std::size_t kBlockRows = 1024;     // Rows a query filters at a time
+
+    mutable std::shared_mutex mutex_;  // Shared by queries, exclusive while a write is applied
+
+    std::vector<std::int32_t> ids_;    // Ascending
+    std::vector<std::uint32_t> names_;
+    std::vector<std::uint32_t> types_;
+    std::vector<std::uint32_t> serial_numbers_;
+    std::vector<std::int32_t> creation_dates_;
+    std::vector<std::int32_t> location_ids_;
+    std::vector<std::uint8_t> live_;   // 0 for a deleted row
+    Dictionary name_codes_;
+    Dictionary type_codes_;
+    Dictionary serial_number_codes_;
+    std::unordered_map<int, std::string> irregular_dates_;  // By device id
+    std::size_t tombstones_;
+    std::size_t garbage_;              // Dictionary values possibly orphaned by updates since the last compaction
+
+    std::map<int, std::string> locations_;       // Location names by id
+    std::vector<std::uint8_t> location_exists_;  // Indexed by location id, for the join on locations
+
+    mutable std::atomic<std::uint64_t> hits_;
+    mutable std::atomic<std::uint64_t> fallbacks_;
+
+    /**
+     * @brief A member function that converts a yyyy-mm-dd date into yyyymmdd, which orders the same way.
+     * @param date The date.
+     * @param value Set to the integer date.
+     * @return True if the date has the yyyy-mm-dd shape, false otherwise.
+     */
+    static bool encodeDate(std::string_view date, std::int32_t& value);
+
+    /**
+     * @brief A member function that returns the row of the given device.
+     * @param id The id of the device.
+     * @return The row, or ids_.size() if the device is not in the snapshot.
+     */
+    std::size_t findRow(int id) const;
+
+    /**
+     * @brief A member function that writes a device into a row, encoding its fields.
+     * @param row The row.
+     * @param device The device.
+     */
+    void setRow(std::size_t row, const DeviceView& device);
+
+    /**
+     * @brief A member function that adds a device in id order, or overwrites it if its id is already known,
+     *        without taking the lock.
+     * @param device The device, whose id is set.
+     */
+    void insertUnlocked(const DeviceView& device);
+
+    /**
+     * @brief A member function that rebuilds the columns and the dictionaries from the live rows once
+     *        deleted rows and stale dictionary values make up a quarter of the table.
+     */
+    void compactIfNeeded();
+
+    /**
+     * @brief A member function that reads a row back into a device.
+     * @param row The row.
+     * @return The device.
+     */
+    Device readRow(std::size_t row) const;
+
+public:
+    /**
+     * @brief A constructor for the DeviceSnapshot class. The snapshot is empty until it is loaded.
+     */
+    DeviceSnapshot();
+
+    /**
+     * @brief A member function that empties the snapshot before it is loaded with insertDevice.
+     * @param locations The rows of the locations table.
+     */
+    void reset(const std::vector<Location>& locations);
+
+    /**
+     * @brief A member function that applies an inserted device, or loads a row of the devices table.
+     * @param device The device, with the id SQLite gave it.
+     */
+    void insertDevice(const DeviceView& device);
+
+    /**
+     * @brief A member function that applies the devices inserted by a batch.
+     * @param devices The devices, with the ids SQLite gave them.
+     */
+    void insertDevices(const std::vector<Device>& devices);
+
+    /**
+     * @brief A member function that applies an updated device.
+     * @param device The new fields of the device.
+     */
+    void updateDevice(const Device& device);
+
+    /**
+     * @brief A member function that applies a deleted device.
+     * @param id The id of the device.
+     */
+    void deleteDevice(int id);
+
+    /**
+     * @brief A member function that applies an inserted or updated location.
+     * @param id The id of the location.
+     * @param name The name of the location.
+     */
+    void putLocation(int id, const std::string& name);
+
+    /**
+     * @brief A member function that applies a deleted location.
+     * @param id The id of the location.
+     */
+    void deleteLocation(int id);
+
+    /**
+     * @brief A member function that answers a getDevicesWithFilters query, with the same semantics as its SQL:
+     *        empty filters are ignored, the others must match exactly, dates compare as text and devices
+     *        without an existing location are left out.
+     * @param name The name of the device.
+     * @param type The type of the device.
+     * @param serial_number The serial number of the device.
+     * @param creation_date_start The start date of the creation date of the device.
+     * @param creation_date_end The end date of the creation date of the device.
+     * @param location The name of the location of the device.
+     * @param after_id Only devices with a greater id are returned.
+     * @param limit The maximum number of devices returned, -1 for no limit.
+     * @param devices Set to the matching devices, ordered by id.
+     * @return True if the query was answered, false if it must run on SQLite: it filters on the serial number,
+     *         which the unique index finds faster, or a date bound or a stored creation date is not yyyy-mm-dd.
+     */
+    bool query(const std::string& name, const std::string& type, const std::string& serial_number,
+               const std::string& creation_date_start, const std::string& creation_date_end,
+               const std::string& location, int after_id, int limit, std::vector<Device>& devices) const;
+
+    /**
+     * @brief A member function that returns the counters and sizes of the snapshot.
+     * @return The current counters.
+     */
+    SnapshotStats stats() const;
+};
+
+} // namespace database
+
+#endif // DEVICE_SNAPSHOT_HPP
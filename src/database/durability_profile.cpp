@@ -0,0 +1,71 @@
+/**
+ * @file    durability_profile.cpp
+ * @brief   This file contains the implementation of the DurabilityProfile struct.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include "../logging/logger.hpp"
+#include "durability_profile.hpp"
+
+namespace database {
+
+DurabilityProfile DurabilityProfile::safe() {
+    return { "safe", "WAL", "FULL", 0, -2000, 5000, "DEFAULT" };
+}
+
+DurabilityProfile DurabilityProfile::balanced() {
+    return { "balanced", "WAL", "NORMAL", 256LL * 1024 * 1024, -16000, 5000, "MEMORY" };
+}
+
+DurabilityProfile DurabilityProfile::throughput() {
+    return { "throughput", "WAL", "OFF", 1024LL * 1024 * 1024, -64000, 10000, "MEMORY" };
+}
+
+std::optional<DurabilityProfile> DurabilityProfile::fromName(const std::string& name) {
+    if (name == "safe") return safe();
+    if (name == "balanced") return balanced();
+    if (name == "throughput") return throughput();
+    return std::nullopt;
+}
+
+bool DurabilityProfile::apply(sqlite3* db) const {
+    // journal_mode answers with the mode actually in effect, which differs from the request e.g. for in-memory databases
+    std::string active_journal_mode;
+    auto read_mode = [](void* out, int, char** values, char**) {
+        *static_cast<std::string*>(out) = values[0] ? values[0] : "";
+        return 0;
+    };
+    std::string sql = "PRAGMA journal_mode = " + journal_mode + ";";
+    char* errMsg;
+    if (sqlite3_exec(db, sql.c_str(), read_mode, &active_journal_mode, &errMsg) != SQLITE_OK) {
+        logging::error() << "Error setting journal mode: " << errMsg;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    if (sqlite3_stricmp(active_journal_mode.c_str(), journal_mode.c_str()) != 0) {
+        logging::warn() << "Requested journal mode " << journal_mode << ", database uses " << active_journal_mode;
+    }
+
+    sql = "PRAGMA synchronous = " + synchronous + ";"
+          "PRAGMA mmap_size = " + std::to_string(mmap_size) + ";"
+          "PRAGMA cache_size = " + std::to_string(cache_size) + ";"
+          "PRAGMA temp_store = " + temp_store + ";";
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        logging::error() << "Error applying durability profile '" << name << "': " << errMsg;
+        sqlite3_free(errMsg);
+        return false;
+    }
+
+    sqlite3_busy_timeout(db, busy_timeout_ms);
+    return true;
+}
+
+std::string DurabilityProfile::describe() const {
+    return "profile=" + name + " journal_mode=" + journal_mode + " synchronous=" + synchronous
+         + " mmap_size=" + std::to_string(mmap_size) + " cache_size=" + std::to_string(cache_size)
+         + " busy_timeout=" + std::to_string(busy_timeout_ms) + "ms temp_store=" + temp_store;
+}
+
+} // namespace database
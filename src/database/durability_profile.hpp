@@ -0,0 +1,73 @@
+/**
+ * @file    durability_profile.hpp
+ * @brief   This file contains the declaration of the DurabilityProfile struct.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef DURABILITY_PROFILE_HPP
+#define DURABILITY_PROFILE_HPP
+
+#include <sqlite3.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace database {
+
+/**
+ * @brief The SQLite settings applied to every connection when it is opened.
+ *        They trade commit durability against write latency and read throughput.
+ */
+struct DurabilityProfile {
+    std::string name;
+    std::string journal_mode;   // "WAL" lets readers proceed while a write commits
+    std::string synchronous;    // "FULL", "NORMAL" or "OFF"
+    std::int64_t mmap_size;     // Bytes of the database file mapped into memory, 0 disables mmap
+    int cache_size;             // Page cache size, in pages if positive and in KiB if negative
+    int busy_timeout_ms;        // How long a connection waits for a lock before SQLITE_BUSY
+    std::string temp_store;     // "DEFAULT", "FILE" or "MEMORY"
+
+    /**
+     * @brief WAL with a full sync on every commit: no committed transaction is lost on power failure.
+     */
+    static DurabilityProfile safe();
+
+    /**
+     * @brief WAL with syncs at checkpoints only: a power failure may roll back the last commits,
+     *        but the database is never corrupted.
+     */
+    static DurabilityProfile balanced();
+
+    /**
+     * @brief WAL without syncs and with large caches. Only a crash of the process itself is safe: an OS crash
+     *        or a power failure can corrupt the database file, not just lose recent commits. Use it for
+     *        databases that can be rebuilt, such as benchmarks and bulk loads.
+     */
+    static DurabilityProfile throughput();
+
+    /**
+     * @brief A member function that returns the preset with the given name.
+     * @param name The name of the preset: "safe", "balanced" or "throughput".
+     * @return The preset if the name is known, an empty optional otherwise.
+     */
+    static std::optional<DurabilityProfile> fromName(const std::string& name);
+
+    /**
+     * @brief A member function that applies the profile to a connection.
+     * @param db The connection to be configured.
+     * @return True if every setting is applied successfully, false otherwise.
+     */
+    bool apply(sqlite3* db) const;
+
+    /**
+     * @brief A member function that describes the profile in one line for the startup log.
+     * @return The description.
+     */
+    std::string describe() const;
+};
+
+} // namespace database
+
+#endif // DURABILITY_PROFILE_HPP
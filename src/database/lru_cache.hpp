@@ -0,0 +1,174 @@
+/**
+ * @file    lru_cache.hpp
+ * @brief   This file contains the declaration and implementation of the LruCache class template.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef LRU_CACHE_HPP
+#define LRU_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace database {
+
+/**
+ * @brief A snapshot of the counters of a cache.
+ */
+struct CacheStats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t evictions;
+    std::size_t size;
+    std::size_t capacity;
+};
+
+/**
+ * @brief A bounded, thread-safe least-recently-used cache. Keys are spread over independently locked shards
+ *        so concurrent lookups of different keys rarely contend.
+ *
+ *        Read-through callers must take generation() before reading the source and pass it to put(), so a value
+ *        read before a concurrent invalidate() is never cached after it.
+ */
+template <typename Key, typename Value>
+class LruCache {
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::list<std::pair<Key, Value>> entries;  // Most recently used first
+        std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator> index;
+        std::uint64_t generation = 0;              // Bumped by every invalidation in this shard
+    };
+
+    std::size_t shard_capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<std::uint64_t> hits_;
+    std::atomic<std::uint64_t> misses_;
+    std::atomic<std::uint64_t> evictions_;
+
+    Shard& shardFor(const Key& key) const {
+        return *shards_[std::hash<Key>()(key) % shards_.size()];
+    }
+
+public:
+    /**
+     * @brief A constructor for the LruCache class.
+     * @param capacity The maximum number of entries, 0 disables the cache.
+     * @param shard_count The number of independently locked shards.
+     */
+    explicit LruCache(std::size_t capacity, std::size_t shard_count = 16)
+        : shard_capacity_(capacity == 0 ? 0 : (capacity + shard_count - 1) / shard_count)
+        , hits_(0)
+        , misses_(0)
+        , evictions_(0) {
+        for (std::size_t i = 0; i < shard_count; ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    /**
+     * @brief A member function that looks a key up and marks it as most recently used.
+     * @param key The key to be looked up.
+     * @return The cached value, an empty optional on a miss.
+     */
+    std::optional<Value> get(const Key& key) {
+        if (shard_capacity_ == 0) {
+            return std::nullopt;
+        }
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second->second;
+    }
+
+    /**
+     * @brief A member function that returns the invalidation generation of the shard holding the key.
+     * @param key The key about to be read from the source.
+     * @return The generation to be passed to put().
+     */
+    std::uint64_t generation(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.generation;
+    }
+
+    /**
+     * @brief A member function that caches a value read from the source, evicting the least recently used
+     *        entry of the shard if it is full. Nothing is cached if the key was invalidated since generation.
+     * @param key The key of the value.
+     * @param value The value read from the source.
+     * @param generation The generation taken before the source was read.
+     */
+    void put(const Key& key, const Value& value, std::uint64_t generation) {
+        if (shard_capacity_ == 0) {
+            return;
+        }
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.generation != generation) {
+            return;
+        }
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            it->second->second = value;
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            return;
+        }
+        if (shard.entries.size() >= shard_capacity_) {
+            shard.index.erase(shard.entries.back().first);
+            shard.entries.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.entries.emplace_front(key, value);
+        shard.index.emplace(key, shard.entries.begin());
+    }
+
+    /**
+     * @brief A member function that removes a key after its source value changed.
+     * @param key The key to be removed.
+     */
+    void invalidate(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.generation++;
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            shard.entries.erase(it->second);
+            shard.index.erase(it);
+        }
+    }
+
+    /**
+     * @brief A member function that returns the counters of the cache.
+     * @return The current counters.
+     */
+    CacheStats stats() const {
+        std::size_t size = 0;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            size += shard->entries.size();
+        }
+        return { hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed),
+                 evictions_.load(std::memory_order_relaxed), size, shard_capacity_ * shards_.size() };
+    }
+};
+
+} // namespace database
+
+#endif // LRU_CACHE_HPP
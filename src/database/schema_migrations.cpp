@@ -0,0 +1,119 @@
+/**
+ * @file    schema_migrations.cpp
+ * @brief   This file contains the schema history of the device database and the implementation of the MigrationRunner class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <chrono>
+#include "../logging/logger.hpp"
+#include "schema_migrations.hpp"
+
+namespace database {
+
+const std::vector<Migration>& schemaMigrations() {
+    static const std::vector<Migration> migrations = {
+        // Databases created before the migration runner are at version 0 but already have these tables,
+        // hence IF NOT EXISTS in the first two steps
+        { 1, "create devices and locations tables", R"(
+            CREATE TABLE IF NOT EXISTS devices (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                name TEXT NOT NULL,
+                type TEXT NOT NULL,
+                serial_number TEXT UNIQUE NOT NULL,
+                creation_date TEXT NOT NULL,
+                location_id INTEGER,
+                FOREIGN KEY (location_id) REFERENCES locations(id) ON DELETE RESTRICT
+            );
+            CREATE TABLE IF NOT EXISTS locations (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                name TEXT NOT NULL,
+                type TEXT NOT NULL
+            );
+        )" },
+        // One index per getDevicesWithFilters predicate. type + creation_date serves "type within a date range"
+        // and plain type lookups, location_id serves the join to locations and the ON DELETE RESTRICT check.
+        { 2, "create device filter indexes", R"(
+            CREATE INDEX IF NOT EXISTS idx_devices_type_creation_date ON devices (type, creation_date);
+            CREATE INDEX IF NOT EXISTS idx_devices_name ON devices (name);
+            CREATE INDEX IF NOT EXISTS idx_devices_creation_date ON devices (creation_date);
+            CREATE INDEX IF NOT EXISTS idx_devices_location_id ON devices (location_id);
+            CREATE INDEX IF NOT EXISTS idx_locations_name ON locations (name);
+        )" },
+        // Filter pages are read in id order. SQLite ends every index with the rowid, which is the id, so an equality
+        // on (type) walks the matches in id order and stops at the page limit; (type, creation_date) did not, because
+        // its date range made SQLite sort every match. creation_date stays for date grouping.
+        { 3, "order device type index by id", R"(
+            DROP INDEX IF EXISTS idx_devices_type_creation_date;
+            CREATE INDEX IF NOT EXISTS idx_devices_type ON devices (type);
+        )" },
+    };
+    return migrations;
+}
+
+MigrationRunner::MigrationRunner(std::vector<Migration> migrations)
+    : migrations_(std::move(migrations)) {}
+
+int MigrationRunner::latestVersion() const {
+    return migrations_.empty() ? 0 : migrations_.back().version;
+}
+
+bool MigrationRunner::readVersion(sqlite3* db, int& version) {
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, nullptr) != SQLITE_OK) {
+        logging::error() << "Failed to read schema version: " << sqlite3_errmsg(db);
+        return false;
+    }
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    if (found) {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+bool MigrationRunner::apply(sqlite3* db, const Migration& migration) {
+    // PRAGMA user_version is transactional, so the schema change and its version commit or roll back together
+    std::string sql = "BEGIN IMMEDIATE;" + migration.sql
+                    + "PRAGMA user_version = " + std::to_string(migration.version) + "; COMMIT;";
+    char* errMsg;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        logging::error() << "Migration " << migration.version << " (" << migration.description << ") failed: " << errMsg;
+        sqlite3_free(errMsg);
+        if (!sqlite3_get_autocommit(db)) {
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool MigrationRunner::run(sqlite3* db) {
+    int version;
+    if (!readVersion(db, version)) {
+        return false;
+    }
+    if (version > latestVersion()) {
+        logging::error() << "Database schema version " << version << " is newer than the supported version "
+                         << latestVersion();
+        return false;
+    }
+
+    for (const Migration& migration : migrations_) {
+        if (migration.version <= version) {
+            continue;
+        }
+        auto started = std::chrono::steady_clock::now();
+        if (!apply(db, migration)) {
+            return false;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        logging::info() << "Applied migration " << migration.version << " (" << migration.description << ") in "
+                        << elapsed.count() << " ms";
+        version = migration.version;
+    }
+    return true;
+}
+
+} // namespace database
@@ -0,0 +1,81 @@
+/**
+ * @file    schema_migrations.hpp
+ * @brief   This file contains the declaration of the schema migrations and of the MigrationRunner class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef SCHEMA_MIGRATIONS_HPP
+#define SCHEMA_MIGRATIONS_HPP
+
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+
+namespace database {
+
+/**
+ * @brief One step of the schema history. The schema version of a database is stored in PRAGMA user_version,
+ *        a migration is applied when its version is greater than the stored one.
+ */
+struct Migration {
+    int version;
+    std::string description;
+    std::string sql;
+};
+
+/**
+ * @brief A function that returns the schema history of the device database, ordered by version.
+ *        New schema changes are appended here with the next version number; applied migrations are never edited.
+ * @return The migrations.
+ */
+const std::vector<Migration>& schemaMigrations();
+
+class MigrationRunner {
+private:
+    std::vector<Migration> migrations_;
+
+    /**
+     * @brief A member function that reads the schema version of the database.
+     * @param db The connection to the database.
+     * @param version The stored version.
+     * @return True if the version is read successfully, false otherwise.
+     */
+    static bool readVersion(sqlite3* db, int& version);
+
+    /**
+     * @brief A member function that applies one migration and records its version in the same transaction.
+     * @param db The connection to the database.
+     * @param migration The migration to be applied.
+     * @return True if the migration is applied successfully, false if it was rolled back.
+     */
+    static bool apply(sqlite3* db, const Migration& migration);
+
+public:
+    /**
+     * @brief A constructor for the MigrationRunner class.
+     * @param migrations The migrations, ordered by version.
+     */
+    explicit MigrationRunner(std::vector<Migration> migrations);
+
+    /**
+     * @brief A member function that applies every pending migration in order, each in its own transaction,
+     *        so a long step such as an index build only holds the write lock for itself. In WAL mode readers
+     *        keep reading the previous schema version while a step runs.
+     * @param db The connection to the database.
+     * @return True if the database is at the latest version, false if a migration failed or the database
+     *         was written by a newer schema version.
+     */
+    bool run(sqlite3* db);
+
+    /**
+     * @brief A member function that returns the version of the last migration.
+     * @return The latest schema version.
+     */
+    int latestVersion() const;
+};
+
+} // namespace database
+
+#endif // SCHEMA_MIGRATIONS_HPP
@@ -0,0 +1,56 @@
+/**
+ * @file    statement_cache.cpp
+ * @brief   This file contains the implementation of the StatementCache class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include "../logging/logger.hpp"
+#include "statement_cache.hpp"
+
+namespace database {
+
+StatementCache::StatementCache(sqlite3* db)
+    : db_(db)
+    , hits_(0)
+    , misses_(0)
+    , size_(0) {}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+std::uint64_t StatementCache::makeKey(StatementKind kind, std::uint32_t variant) {
+    return (static_cast<std::uint64_t>(kind) << 32) | variant;
+}
+
+sqlite3_stmt* StatementCache::prepare(std::uint64_t key, const std::string& sql) {
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v3(db_, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        logging::error() << "Failed to prepare statement: " << sqlite3_errmsg(db_);
+        return nullptr;
+    }
+    statements_.emplace(key, stmt);
+    size_.store(statements_.size(), std::memory_order_relaxed);
+    return stmt;
+}
+
+sqlite3_stmt* StatementCache::acquire(StatementKind kind, const char* sql) {
+    return acquire(kind, 0, [sql] { return std::string(sql); });
+}
+
+void StatementCache::clear() {
+    for (auto& entry : statements_) {
+        sqlite3_finalize(entry.second);
+    }
+    statements_.clear();
+    size_.store(0, std::memory_order_relaxed);
+}
+
+StatementCacheStats StatementCache::stats() const {
+    return { hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed),
+             size_.load(std::memory_order_relaxed) };
+}
+
+} // namespace database
@@ -0,0 +1,159 @@
+/**
+ * @file    statement_cache.hpp
+ * @brief   This file contains the declaration of the StatementCache class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef STATEMENT_CACHE_HPP
+#define STATEMENT_CACHE_HPP
+
+#include <sqlite3.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace database {
+
+/**
+ * @brief The kinds of statements the DatabaseManager keeps prepared.
+ */
+enum class StatementKind : std::uint32_t {
+    AddDevice,
+    GetDevice,
+    GetAllDevices,
+    GetDevicesPage,
+    UpdateDevice,
+    DeleteDevice,
+    FilterDevices,
+    AddLocation,
+    GetLocation,
+    GetAllLocations,
+    GetLocationsPage,
+    UpdateLocation,
+    DeleteLocation,
+    CountDevices,
+    FindLocationIds,
+};
+
+/**
+ * @brief A snapshot of the statement cache counters.
+ */
+struct StatementCacheStats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::size_t size;
+};
+
+class StatementCache {
+private:
+    sqlite3* db_;
+    std::unordered_map<std::uint64_t, sqlite3_stmt*> statements_;
+    std::atomic<std::uint64_t> hits_;
+    std::atomic<std::uint64_t> misses_;
+    std::atomic<std::size_t> size_;  // statements_.size(), readable while a worker holds the connection
+
+    /**
+     * @brief A member function that builds the cache key of a statement.
+     * @param kind The kind of the statement.
+     * @param variant The variant of the statement, e.g. the filter mask.
+     * @return The cache key.
+     */
+    static std::uint64_t makeKey(StatementKind kind, std::uint32_t variant);
+
+    /**
+     * @brief A member function that prepares a statement and stores it in the cache.
+     * @param key The cache key of the statement.
+     * @param sql The SQL text of the statement.
+     * @return The prepared statement, nullptr if it could not be prepared.
+     */
+    sqlite3_stmt* prepare(std::uint64_t key, const std::string& sql);
+
+public:
+    /**
+     * @brief A constructor for the StatementCache class.
+     * @param db The connection the statements are prepared on.
+     */
+    explicit StatementCache(sqlite3* db);
+
+    /**
+     * @brief A destructor for the StatementCache class. Finalizes every cached statement.
+     */
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    /**
+     * @brief A member function that returns the cached statement of the given kind,
+     *        preparing it on first use.
+     * @param kind The kind of the statement.
+     * @param sql The SQL text of the statement, only used on a cache miss.
+     * @return The prepared statement, nullptr if it could not be prepared.
+     */
+    sqlite3_stmt* acquire(StatementKind kind, const char* sql);
+
+    /**
+     * @brief A member function that returns the cached statement of the given kind and variant,
+     *        preparing it on first use.
+     * @param kind The kind of the statement.
+     * @param variant The variant of the statement, e.g. the filter mask.
+     * @param build_sql A callable returning the SQL text, only invoked on a cache miss.
+     * @return The prepared statement, nullptr if it could not be prepared.
+     */
+    template <typename SqlBuilder>
+    sqlite3_stmt* acquire(StatementKind kind, std::uint32_t variant, SqlBuilder&& build_sql) {
+        std::uint64_t key = makeKey(kind, variant);
+        auto it = statements_.find(key);
+        if (it != statements_.end()) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return prepare(key, build_sql());
+    }
+
+    /**
+     * @brief A member function that finalizes and removes every cached statement.
+     */
+    void clear();
+
+    /**
+     * @brief A member function that returns the hit/miss counters of the cache. Only reads atomics,
+     *        so it may be called while another thread uses the connection.
+     * @return The current counters.
+     */
+    StatementCacheStats stats() const;
+};
+
+/**
+ * @brief An RAII guard that resets a cached statement and clears its bindings when it goes out of scope,
+ *        so the statement is ready for its next use and holds no read lock in between.
+ */
+class ScopedStatement {
+private:
+    sqlite3_stmt* stmt_;
+
+public:
+    explicit ScopedStatement(sqlite3_stmt* stmt) : stmt_(stmt) {}
+
+    ~ScopedStatement() {
+        if (stmt_) {
+            sqlite3_reset(stmt_);
+            sqlite3_clear_bindings(stmt_);
+        }
+    }
+
+    ScopedStatement(const ScopedStatement&) = delete;
+    ScopedStatement& operator=(const ScopedStatement&) = delete;
+
+    sqlite3_stmt* get() const { return stmt_; }
+
+    explicit operator bool() const { return stmt_ != nullptr; }
+};
+
+} // namespace database
+
+#endif // STATEMENT_CACHE_HPP
@@ -0,0 +1,323 @@
+/**
+ * @file    logger.cpp
+ * @brief   This file contains the implementation of the Logger and LogLine classes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include "../serialization/json_writer.hpp"
+#include "logger.hpp"
+
+namespace logging {
+
+namespace {
+
+const char* levelName(Level level) {
+    switch (level) {
+        case Level::Debug: return "debug";
+        case Level::Info: return "info";
+        case Level::Warn: return "warn";
+        case Level::Error: return "error";
+        default: return "off";
+    }
+}
+
+std::int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// FNV-1a over the message with its digits skipped, so "id: 17" and "id: 42" count as the same message
+std::uint64_t messageKey(std::string_view message) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : message) {
+        if (c >= '0' && c <= '9') continue;
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return hash | 1;  // Never 0, the key of an unused slot
+}
+
+// 2026-10-16T08:30:00.123Z
+void appendTimestamp(std::string& out, std::int64_t time_us) {
+    std::time_t seconds = static_cast<std::time_t>(time_us / 1000000);
+    std::tm tm;
+    gmtime_r(&seconds, &tm);
+    char buffer[32];
+    std::size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &tm);
+    out.append(buffer, length);
+    std::snprintf(buffer, sizeof(buffer), ".%03dZ", static_cast<int>((time_us / 1000) % 1000));
+    out.append(buffer);
+}
+
+void writeOut(std::FILE* stream, const std::string& text) {
+    if (!text.empty()) {
+        std::fwrite(text.data(), 1, text.size(), stream);
+        std::fflush(stream);
+    }
+}
+
+thread_local bool lineBufferInUse = false;
+
+} // namespace
+
+std::optional<Level> levelFromName(std::string_view name) {
+    for (Level level : { Level::Debug, Level::Info, Level::Warn, Level::Error, Level::Off }) {
+        if (name == levelName(level)) return level;
+    }
+    return std::nullopt;
+}
+
+std::optional<Format> formatFromName(std::string_view name) {
+    if (name == "text") return Format::Text;
+    if (name == "json") return Format::Json;
+    return std::nullopt;
+}
+
+Logger::Logger()
+    : slots_(std::make_unique<Slot[]>(CAPACITY))
+    , enqueue_pos_(0)
+    , dequeue_pos_(0)
+    , level_(static_cast<int>(Level::Info))
+    , format_(static_cast<int>(Format::Text))
+    , rate_limit_(0)
+    , dropped_(0)
+    , stopped_(false)
+    , flushed_pos_(0)
+    , stopping_(false) {
+    for (std::size_t i = 0; i < CAPACITY; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    flusher_ = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    stop();
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+void Logger::configure(Level level, Format format, std::uint32_t rate_limit) {
+    level_.store(static_cast<int>(level), std::memory_order_relaxed);
+    format_.store(static_cast<int>(format), std::memory_order_relaxed);
+    rate_limit_.store(rate_limit, std::memory_order_relaxed);
+}
+
+bool Logger::admit(std::string_view message, std::uint32_t& suppressed) {
+    suppressed = 0;
+    std::uint32_t limit = rate_limit_.load(std::memory_order_relaxed);
+    if (limit == 0) {
+        return true;
+    }
+    // Approximate by design: racing callers may let a few extra repeats through, but never take a lock
+    std::uint64_t key = messageKey(message);
+    RateSlot& slot = rate_slots_[key % rate_slots_.size()];
+    std::int64_t window = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (slot.key.load(std::memory_order_relaxed) != key || slot.window.load(std::memory_order_relaxed) != window) {
+        if (slot.key.exchange(key, std::memory_order_relaxed) == key) {
+            suppressed = slot.suppressed.exchange(0, std::memory_order_relaxed);
+        } else {
+            slot.suppressed.store(0, std::memory_order_relaxed);
+        }
+        slot.window.store(window, std::memory_order_relaxed);
+        slot.count.store(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (slot.count.fetch_add(1, std::memory_order_relaxed) < limit) {
+        return true;
+    }
+    slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void Logger::write(Level level, std::string_view message) {
+    if (!enabled(level)) {
+        return;
+    }
+    std::uint32_t suppressed;
+    if (!admit(message, suppressed)) {
+        return;
+    }
+    std::string note;
+    if (suppressed > 0) {
+        note = " (" + std::to_string(suppressed) + " similar messages suppressed)";
+    }
+
+    if (stopped_.load(std::memory_order_acquire)) {
+        std::string out;
+        format(out, level, nowMicros(), std::string(message) + note);
+        writeOut(level >= Level::Warn ? stderr : stdout, out);
+        return;
+    }
+
+    // Bounded MPMC queue (D. Vyukov): a producer claims a position with one CAS, then publishes the slot
+    std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots_[pos & (CAPACITY - 1)];
+        std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);  // Full: never block the caller
+            return;
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    slot->level = level;
+    slot->time_us = nowMicros();
+    slot->message.assign(message.data(), message.size());  // Reuses the capacity of the slot
+    slot->message.append(note);
+    // Sequentially consistent with stop(): either its final drain sees this slot, or this sees stopped_ and drains
+    slot->sequence.store(pos + 1, std::memory_order_seq_cst);
+    if (stopped_.load(std::memory_order_seq_cst)) {
+        drain();  // Checked the flag before stop() set it and published after its drain: nobody else will
+        return;
+    }
+    if ((pos & (CAPACITY / 4 - 1)) == 0) {
+        wake_.notify_one();  // Bursts wake the flusher early instead of waiting for its next poll
+    }
+}
+
+void Logger::format(std::string& out, Level level, std::int64_t time_us, std::string_view message) const {
+    if (static_cast<Format>(format_.load(std::memory_order_relaxed)) == Format::Json) {
+        serialization::JsonWriter writer;
+        writer.append("{\"ts\":\"");
+        std::string timestamp;
+        appendTimestamp(timestamp, time_us);
+        writer.append(timestamp);
+        writer.append("\",\"level\":\"");
+        writer.append(levelName(level));
+        writer.append("\",\"msg\":");
+        writer.writeString(message);
+        writer.append("}\n");
+        out.append(writer.str());
+        return;
+    }
+    appendTimestamp(out, time_us);
+    out += ' ';
+    std::string name = levelName(level);
+    for (char& c : name) c = static_cast<char>(c - 'a' + 'A');
+    name.resize(5, ' ');
+    out += name;
+    out += ' ';
+    out.append(message);
+    out += '\n';
+}
+
+bool Logger::drain() {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    thread_local std::string out;
+    thread_local std::string errors;
+    out.clear();
+    errors.clear();
+    bool wrote = false;
+    for (;;) {
+        Slot& slot = slots_[dequeue_pos_ & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_seq_cst) != dequeue_pos_ + 1) {
+            break;  // Empty, or the next producer has not published yet
+        }
+        format(slot.level >= Level::Warn ? errors : out, slot.level, slot.time_us, slot.message);
+        slot.sequence.store(dequeue_pos_ + CAPACITY, std::memory_order_release);
+        ++dequeue_pos_;
+        wrote = true;
+    }
+
+    static std::uint64_t reportedDropped = 0;
+    std::uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reportedDropped) {
+        format(errors, Level::Warn, nowMicros(),
+               std::to_string(dropped - reportedDropped) + " log messages dropped, the log buffer was full");
+        reportedDropped = dropped;
+    }
+    writeOut(stdout, out);
+    writeOut(stderr, errors);
+    flushed_pos_.store(dequeue_pos_, std::memory_order_release);
+    return wrote;
+}
+
+void Logger::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        lock.unlock();
+        drain();
+        lock.lock();
+        flushed_.notify_all();
+        if (stopping_) {
+            break;
+        }
+        wake_.wait_for(lock, std::chrono::milliseconds(50));
+    }
+}
+
+void Logger::flush() {
+    if (stopped_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::size_t target = enqueue_pos_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mutex_);
+    wake_.notify_one();
+    // Bounded wait: a producer that claimed a slot but has not published it yet must not hang the caller
+    flushed_.wait_for(lock, std::chrono::seconds(1), [&] {
+        return flushed_pos_.load(std::memory_order_acquire) >= target;
+    });
+}
+
+void Logger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    flusher_.join();
+    stopped_.store(true, std::memory_order_seq_cst);
+    // Drains what was published before the switch to synchronous writes. A producer that read stopped_ before
+    // the store but publishes after this drain sees the flag once it has published, and drains its message itself
+    drain();
+}
+
+LogLine::LogLine(Level level)
+    : level_(level)
+    , enabled_(Logger::instance().enabled(level))
+    , owns_buffer_(!enabled_ || lineBufferInUse) {
+    if (owns_buffer_) {
+        buffer_ = &own_;  // Disabled, or composed while another line is (e.g. a value that logs when built)
+    } else {
+        thread_local std::string buffer;
+        buffer.clear();
+        buffer_ = &buffer;
+        lineBufferInUse = true;
+    }
+}
+
+LogLine::~LogLine() {
+    if (enabled_) {
+        Logger::instance().write(level_, *buffer_);
+    }
+    if (!owns_buffer_) {
+        lineBufferInUse = false;
+    }
+}
+
+LogLine& LogLine::operator<<(double value) {
+    if (enabled_) {
+        char digits[32];
+        int length = std::snprintf(digits, sizeof(digits), "%g", value);
+        buffer_->append(digits, length);
+    }
+    return *this;
+}
+
+} // namespace logging
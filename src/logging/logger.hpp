@@ -0,0 +1,240 @@
+/**
+ * @file    logger.hpp
+ * @brief   This file contains the declaration of the Logger and LogLine classes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace logging {
+
+enum class Level : int { Debug, Info, Warn, Error, Off };
+
+enum class Format { Text, Json };
+
+/**
+ * @brief A function that returns the level with the given name.
+ * @param name "debug", "info", "warn", "error" or "off".
+ * @return The level, std::nullopt if the name is unknown.
+ */
+std::optional<Level> levelFromName(std::string_view name);
+
+/**
+ * @brief A function that returns the format with the given name.
+ * @param name "text" or "json".
+ * @return The format, std::nullopt if the name is unknown.
+ */
+std::optional<Format> formatFromName(std::string_view name);
+
+/**
+ * @brief The process-wide logger. Callers only copy their message into a lock-free ring buffer;
+ *        a background thread formats the messages and writes them out in batches, info and debug
+ *        messages to stdout, warnings and errors to stderr. When the buffer is full messages are
+ *        dropped and counted instead of blocking the caller.
+ */
+class Logger {
+public:
+    static constexpr std::size_t CAPACITY = 8192;  // Messages the ring buffer holds, a power of two
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        Level level;
+        std::int64_t time_us;
+        std::string message;
+    };
+
+    // Repeats of a message, ignoring the digits in it, are counted per one-second window
+    struct alignas(64) RateSlot {
+        std::atomic<std::uint64_t> key{ 0 };
+        std::atomic<std::int64_t> window{ -1 };
+        std::atomic<std::uint32_t> count{ 0 };
+        std::atomic<std::uint32_t> suppressed{ 0 };
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<std::size_t> enqueue_pos_;
+    alignas(64) std::size_t dequeue_pos_;
+    std::array<RateSlot, 256> rate_slots_;
+    std::atomic<int> level_;
+    std::atomic<int> format_;
+    std::atomic<std::uint32_t> rate_limit_;
+    std::atomic<std::uint64_t> dropped_;
+    std::atomic<bool> stopped_;
+    std::atomic<std::size_t> flushed_pos_;
+    std::mutex drain_mutex_;  // One consumer at a time: the flusher thread, then stop() and late producers
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    bool stopping_;
+    std::thread flusher_;
+
+    Logger();
+
+    /**
+     * @brief A member function that tells whether a message is within the rate limit.
+     * @param message The message to be logged.
+     * @param suppressed Set to the number of repeats dropped since the message was last admitted.
+     * @return True if the message is to be logged.
+     */
+    bool admit(std::string_view message, std::uint32_t& suppressed);
+
+    /**
+     * @brief A member function that formats one message and appends it to an output buffer.
+     * @param out The output buffer.
+     * @param level The level of the message.
+     * @param time_us The time the message was logged, in microseconds since the epoch.
+     * @param message The message.
+     */
+    void format(std::string& out, Level level, std::int64_t time_us, std::string_view message) const;
+
+    /**
+     * @brief A member function that drains the ring buffer and writes the messages out. Takes drain_mutex_.
+     * @return True if any message was written.
+     */
+    bool drain();
+
+    /**
+     * @brief The body of the flusher thread.
+     */
+    void run();
+
+public:
+    /**
+     * @brief A member function that returns the logger shared by the whole process.
+     * @return The global logger.
+     */
+    static Logger& instance();
+
+    /**
+     * @brief A destructor for the Logger class. Stops the flusher thread after writing every queued message.
+     */
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /**
+     * @brief A member function that configures the logger.
+     * @param level Messages below this level are discarded before they are formatted.
+     * @param format The output format, plain text or one JSON object per line.
+     * @param rate_limit The number of repeats of a message logged per second, 0 for no limit.
+     */
+    void configure(Level level, Format format, std::uint32_t rate_limit);
+
+    /**
+     * @brief A member function that tells whether messages of the given level are logged.
+     * @param level The level.
+     * @return True if the messages are logged.
+     */
+    bool enabled(Level level) const {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief A member function that queues a message. Written synchronously once the logger is stopped.
+     * @param level The level of the message.
+     * @param message The message.
+     */
+    void write(Level level, std::string_view message);
+
+    /**
+     * @brief A member function that waits until every message queued so far is written out.
+     */
+    void flush();
+
+    /**
+     * @brief A member function that writes every queued message and stops the flusher thread.
+     *        Later messages are written synchronously.
+     */
+    void stop();
+
+    /**
+     * @brief A member function that returns the number of messages dropped because the buffer was full.
+     * @return The number of dropped messages.
+     */
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief A message being composed with operator<<, queued when the statement ends. Nothing is
+ *        formatted if its level is disabled. Use through logging::debug(), info(), warn() and error().
+ */
+class LogLine {
+private:
+    Level level_;
+    bool enabled_;
+    bool owns_buffer_;
+    std::string own_;
+    std::string* buffer_;
+
+public:
+    explicit LogLine(Level level);
+
+    ~LogLine();
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(std::string_view text) {
+        if (enabled_) buffer_->append(text);
+        return *this;
+    }
+
+    LogLine& operator<<(const char* text) {
+        if (enabled_) buffer_->append(text ? text : "(null)");
+        return *this;
+    }
+
+    LogLine& operator<<(const std::string& text) {
+        if (enabled_) buffer_->append(text);
+        return *this;
+    }
+
+    LogLine& operator<<(char c) {
+        if (enabled_) buffer_->push_back(c);
+        return *this;
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>>>
+    LogLine& operator<<(T value) {
+        if (enabled_) {
+            char digits[24];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            buffer_->append(digits, result.ptr - digits);
+        }
+        return *this;
+    }
+
+    LogLine& operator<<(bool value) {
+        if (enabled_) buffer_->append(value ? "true" : "false");
+        return *this;
+    }
+
+    LogLine& operator<<(double value);
+};
+
+inline LogLine debug() { return LogLine(Level::Debug); }
+inline LogLine info() { return LogLine(Level::Info); }
+inline LogLine warn() { return LogLine(Level::Warn); }
+inline LogLine error() { return LogLine(Level::Error); }
+
+} // namespace logging
+
+#endif // LOGGER_HPP
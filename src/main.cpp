@@ -6,19 +6,65 @@
  * @version 1.0
  */
 
+#include <csignal>
+#include <iostream>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include "logging/logger.hpp"
 #include "server/server_manager.hpp"
 #include "utilities/config.hpp"
 
-int main() {
+int main(int argc, char* argv[]) {
 
-    server::ServerManager server(PATH_TO_DB, LOCAL_HOST, PORT, THREAD_POOL_SIZE);  // Create a server object
+    // SIGTERM and SIGINT are blocked before any thread starts, the logger's included, and taken by one
+    // thread with sigwait, so a shutdown never runs inside a signal handler
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--help") {
+            std::cout << config::Config::usage();
+            return 0;
+        }
+    }
+
+    std::string error;
+    auto config = config::Config::load(argc, argv, error);  // Defaults, file, environment, then flags
+    if (!config.has_value()) {
+        logging::error() << "Error: invalid configuration: " << error;
+        logging::Logger::instance().stop();
+        return 1;
+    }
+
+    logging::Logger::instance().configure(logging::levelFromName(config->log_level).value(),
+                                          logging::formatFromName(config->log_format).value(),
+                                          config->log_rate_limit_per_second);
+    logging::info() << "Configuration:\n" << config->describe();
+
+    server::ServerManager server(config.value());  // Create a server object
+
+    std::thread signal_thread([&server, &signals, &config] {
+        int signal = 0;
+        sigwait(&signals, &signal);
+        logging::info() << "Received signal " << signal;
+        server.shutdown(std::chrono::milliseconds(config->shutdown_timeout_ms));
+    });
 
     try {
         server.init();  // Initialize the server
         server.start();
     } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
+        logging::error() << "Error: " << e.what();
     }
 
+    pthread_kill(signal_thread.native_handle(), SIGTERM);  // Wakes the signal thread if the server stopped on its own
+    signal_thread.join();
+
+    logging::Logger::instance().stop();  // Write out every queued message
+
     return 0;
 }
@@ -0,0 +1,237 @@
+/**
+ * @file    metrics.cpp
+ * @brief   This file contains the implementation of the Counter, Histogram and Registry classes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "metrics.hpp"
+
+namespace metrics {
+
+namespace {
+
+std::string formatDouble(double value) {
+    if (value == std::floor(value) && std::fabs(value) < 1e15) {
+        return std::to_string(static_cast<long long>(value));  // Counts read from callbacks stay exact
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+void appendEscaped(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default: out += c;
+        }
+    }
+}
+
+// Appends {a="1",b="2"} with an optional extra label such as le, nothing if there are no labels at all
+void appendLabels(std::string& out, const Labels& labels, const char* extra_name = nullptr,
+                  const std::string& extra_value = "") {
+    if (labels.empty() && !extra_name) return;
+    out += '{';
+    bool first = true;
+    for (const auto& label : labels) {
+        if (!first) out += ',';
+        out += label.first;
+        out += "=\"";
+        appendEscaped(out, label.second);
+        out += '"';
+        first = false;
+    }
+    if (extra_name) {
+        if (!first) out += ',';
+        out += extra_name;
+        out += "=\"";
+        out += extra_value;
+        out += '"';
+    }
+    out += '}';
+}
+
+} // namespace
+
+std::size_t threadShard() {
+    static std::atomic<std::size_t> next{ 0 };
+    thread_local std::size_t shard = next.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+    return shard;
+}
+
+std::uint64_t Counter::value() const {
+    std::uint64_t total = 0;
+    for (const auto& cell : cells_) {
+        total += cell.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+const std::array<double, Histogram::BUCKET_COUNT> Histogram::BOUNDS = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+    0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+void Histogram::observe(std::chrono::nanoseconds elapsed) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    std::size_t bucket = std::lower_bound(BOUNDS.begin(), BOUNDS.end(), seconds) - BOUNDS.begin();
+    Cell& cell = cells_[threadShard()];
+    cell.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    cell.sum_ns.fetch_add(static_cast<std::uint64_t>(elapsed.count()), std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot{};
+    std::uint64_t sum_ns = 0;
+    for (const auto& cell : cells_) {
+        for (std::size_t i = 0; i <= BUCKET_COUNT; ++i) {
+            std::uint64_t count = cell.buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += count;
+            snapshot.count += count;
+        }
+        sum_ns += cell.sum_ns.load(std::memory_order_relaxed);
+    }
+    snapshot.sum = static_cast<double>(sum_ns) / 1e9;
+    return snapshot;
+}
+
+Registry& Registry::global() {
+    static Registry registry;
+    return registry;
+}
+
+Registry::Series& Registry::series(const std::string& name, const std::string& help, Type type, const Labels& labels) {
+    auto family = std::find_if(families_.begin(), families_.end(),
+                               [&](const std::unique_ptr<Family>& f) { return f->name == name; });
+    if (family == families_.end()) {
+        families_.push_back(std::make_unique<Family>(Family{ name, help, type, {} }));
+        family = families_.end() - 1;
+    }
+    for (auto& existing : (*family)->series) {
+        if (existing->labels == labels) return *existing;
+    }
+    auto created = std::make_unique<Series>();
+    created->labels = labels;
+    created->callback_id = 0;
+    (*family)->series.push_back(std::move(created));
+    return *(*family)->series.back();
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help, const Labels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& counter = series(name, help, Type::Counter, labels);
+    if (!counter.counter) counter.counter = std::make_unique<Counter>();
+    return *counter.counter;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::string& help, const Labels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& histogram = series(name, help, Type::Histogram, labels);
+    if (!histogram.histogram) histogram.histogram = std::make_unique<Histogram>();
+    return *histogram.histogram;
+}
+
+CallbackHandle Registry::registerCallback(const std::string& name, const std::string& help, Type type,
+                                         const Labels& labels, std::function<double()> read) {
+    Series& callback = series(name, help, type, labels);
+    callback.read = std::move(read);
+    callback.callback_id = next_callback_id_++;
+    return CallbackHandle(this, callback.callback_id);
+}
+
+void Registry::removeCallback(std::uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto family = families_.begin(); family != families_.end(); ++family) {
+        auto& series = (*family)->series;
+        auto found = std::find_if(series.begin(), series.end(), [id](const std::unique_ptr<Series>& s) {
+            return s->read && s->callback_id == id;
+        });
+        if (found == series.end()) {
+            continue;
+        }
+        series.erase(found);  // Callback series hold no counter or histogram anyone could still reference
+        if (series.empty()) {
+            families_.erase(family);
+        }
+        return;
+    }
+}
+
+CallbackHandle Registry::gauge(const std::string& name, const std::string& help, const Labels& labels,
+                               std::function<double()> read) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return registerCallback(name, help, Type::Gauge, labels, std::move(read));
+}
+
+CallbackHandle Registry::counterCallback(const std::string& name, const std::string& help, const Labels& labels,
+                                         std::function<double()> read) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return registerCallback(name, help, Type::Counter, labels, std::move(read));
+}
+
+CallbackHandle& CallbackHandle::operator=(CallbackHandle&& other) noexcept {
+    if (this != &other) {
+        release();
+        registry_ = other.registry_;
+        id_ = other.id_;
+        other.registry_ = nullptr;
+    }
+    return *this;
+}
+
+void CallbackHandle::release() {
+    if (registry_) {
+        registry_->removeCallback(id_);
+        registry_ = nullptr;
+    }
+}
+
+std::string Registry::render() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    out.reserve(16 * 1024);
+    for (const auto& family : families_) {
+        const char* type = family->type == Type::Counter ? "counter"
+                         : family->type == Type::Gauge ? "gauge" : "histogram";
+        out += "# HELP " + family->name + " " + family->help + "\n";
+        out += "# TYPE " + family->name + " " + type + "\n";
+        for (const auto& series : family->series) {
+            if (series->read) {
+                out += family->name;
+                appendLabels(out, series->labels);
+                out += ' ' + formatDouble(series->read()) + '\n';
+            } else if (series->counter) {
+                out += family->name;
+                appendLabels(out, series->labels);
+                out += ' ' + std::to_string(series->counter->value()) + '\n';
+            } else if (series->histogram) {
+                Histogram::Snapshot snapshot = series->histogram->snapshot();
+                std::uint64_t cumulative = 0;
+                for (std::size_t i = 0; i <= Histogram::BUCKET_COUNT; ++i) {
+                    cumulative += snapshot.buckets[i];
+                    out += family->name + "_bucket";
+                    appendLabels(out, series->labels, "le",
+                                 i < Histogram::BUCKET_COUNT ? formatDouble(Histogram::BOUNDS[i]) : "+Inf");
+                    out += ' ' + std::to_string(cumulative) + '\n';
+                }
+                out += family->name + "_sum";
+                appendLabels(out, series->labels);
+                out += ' ' + formatDouble(snapshot.sum) + '\n';
+                out += family->name + "_count";
+                appendLabels(out, series->labels);
+                out += ' ' + std::to_string(snapshot.count) + '\n';
+            }
+        }
+    }
+    return out;
+}
+
+} // namespace metrics
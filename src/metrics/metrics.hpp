@@ -0,0 +1,280 @@
+/**
+ * @file    metrics.hpp
+ * @brief   This file contains the declaration of the Counter, Histogram and Registry classes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace metrics {
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief The number of cells a metric is split into. Each thread writes to its own cell,
+ *        so concurrent workers never contend on the same cache line.
+ */
+constexpr std::size_t SHARD_COUNT = 16;
+
+/**
+ * @brief A function that returns the cell the calling thread writes to.
+ * @return The shard index of the calling thread.
+ */
+std::size_t threadShard();
+
+/**
+ * @brief A monotonically increasing counter.
+ */
+class Counter {
+private:
+    struct alignas(64) Cell {
+        std::atomic<std::uint64_t> value{ 0 };
+    };
+    std::array<Cell, SHARD_COUNT> cells_;
+
+public:
+    /**
+     * @brief A member function that adds to the counter.
+     * @param amount The amount to be added.
+     */
+    void add(std::uint64_t amount = 1) {
+        cells_[threadShard()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief A member function that returns the counter summed over every cell.
+     * @return The current value.
+     */
+    std::uint64_t value() const;
+};
+
+/**
+ * @brief A latency histogram with fixed buckets, from 100us to 10s.
+ */
+class Histogram {
+public:
+    static constexpr std::size_t BUCKET_COUNT = 16;
+
+    /**
+     * @brief The upper bounds of the buckets in seconds. Observations above the last one only land in +Inf.
+     */
+    static const std::array<double, BUCKET_COUNT> BOUNDS;
+
+    /**
+     * @brief A snapshot of the histogram summed over every cell. Bucket counts are not cumulative.
+     */
+    struct Snapshot {
+        std::array<std::uint64_t, BUCKET_COUNT + 1> buckets;
+        std::uint64_t count;
+        double sum;
+    };
+
+private:
+    struct alignas(64) Cell {
+        std::array<std::atomic<std::uint64_t>, BUCKET_COUNT + 1> buckets{};
+        std::atomic<std::uint64_t> sum_ns{ 0 };
+    };
+    std::array<Cell, SHARD_COUNT> cells_;
+
+public:
+    /**
+     * @brief A member function that records one observation.
+     * @param elapsed The observed duration.
+     */
+    void observe(std::chrono::nanoseconds elapsed);
+
+    /**
+     * @brief A member function that returns the histogram summed over every cell.
+     * @return The current snapshot.
+     */
+    Snapshot snapshot() const;
+};
+
+/**
+ * @brief An RAII timer that records the time it was alive into a histogram.
+ */
+class ScopedTimer {
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram)
+        , start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        histogram_.observe(std::chrono::steady_clock::now() - start_);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+class Registry;
+
+/**
+ * @brief An RAII registration of a gauge or counter callback. The callback usually captures the component it
+ *        reads, so the component keeps the handle: destroying it removes the series before the component goes away.
+ */
+class CallbackHandle {
+private:
+    Registry* registry_;
+    std::uint64_t id_;
+
+public:
+    CallbackHandle() : registry_(nullptr), id_(0) {}
+
+    CallbackHandle(Registry* registry, std::uint64_t id) : registry_(registry), id_(id) {}
+
+    ~CallbackHandle() {
+        release();
+    }
+
+    CallbackHandle(CallbackHandle&& other) noexcept : registry_(other.registry_), id_(other.id_) {
+        other.registry_ = nullptr;
+    }
+
+    CallbackHandle& operator=(CallbackHandle&& other) noexcept;
+
+    CallbackHandle(const CallbackHandle&) = delete;
+    CallbackHandle& operator=(const CallbackHandle&) = delete;
+
+    /**
+     * @brief A member function that removes the callback from the registry, unless it was replaced since.
+     *        Waits for a render in progress, so the callback is not running once it returns.
+     */
+    void release();
+};
+
+/**
+ * @brief The set of metrics exposed on /metrics. Metrics are registered once, at startup or on first use,
+ *        and the returned references stay valid for the lifetime of the registry, so recording never locks.
+ *        Callback series are the exception: they live as long as the CallbackHandle they were registered with.
+ */
+class Registry {
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Series {
+        Labels labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()> read;  // Gauges, and counters kept by another component
+        std::uint64_t callback_id;     // The registration read comes from, see CallbackHandle
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        Type type;
+        std::vector<std::unique_ptr<Series>> series;
+    };
+
+    std::vector<std::unique_ptr<Family>> families_;
+    std::uint64_t next_callback_id_ = 1;
+    mutable std::mutex mutex_;
+
+    /**
+     * @brief A member function that returns the series with the given labels, creating it and its family if needed.
+     *        Must be called with the mutex held.
+     * @param name The name of the metric.
+     * @param help The help text of the metric.
+     * @param type The type of the metric.
+     * @param labels The labels of the series.
+     * @return The series.
+     */
+    Series& series(const std::string& name, const std::string& help, Type type, const Labels& labels);
+
+    /**
+     * @brief A member function that registers a callback series. Must be called with the mutex held.
+     * @param name The name of the metric.
+     * @param help The help text of the metric.
+     * @param type The type of the metric.
+     * @param labels The labels of the series.
+     * @param read The callable returning the current value.
+     * @return The handle of the registration.
+     */
+    CallbackHandle registerCallback(const std::string& name, const std::string& help, Type type, const Labels& labels,
+                                    std::function<double()> read);
+
+    /**
+     * @brief A member function that removes the series of a callback registration, and its family once empty.
+     * @param id The id of the registration.
+     */
+    void removeCallback(std::uint64_t id);
+
+    friend class CallbackHandle;
+
+public:
+    /**
+     * @brief A member function that returns the registry shared by the whole process.
+     * @return The global registry.
+     */
+    static Registry& global();
+
+    /**
+     * @brief A member function that returns the counter with the given name and labels, creating it if needed.
+     * @param name The name of the metric, e.g. "http_requests_total".
+     * @param help The help text of the metric.
+     * @param labels The labels of the series.
+     * @return The counter.
+     */
+    Counter& counter(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    /**
+     * @brief A member function that returns the histogram with the given name and labels, creating it if needed.
+     * @param name The name of the metric, e.g. "http_request_duration_seconds".
+     * @param help The help text of the metric.
+     * @param labels The labels of the series.
+     * @return The histogram.
+     */
+    Histogram& histogram(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    /**
+     * @brief A member function that registers a gauge whose value is read when the metrics are rendered.
+     *        Registering the same name and labels again replaces the callback.
+     * @param name The name of the metric.
+     * @param help The help text of the metric.
+     * @param labels The labels of the series.
+     * @param read The callable returning the current value.
+     * @return The handle that keeps the gauge registered; it must not outlive what read captures.
+     */
+    CallbackHandle gauge(const std::string& name, const std::string& help, const Labels& labels, std::function<double()> read);
+
+    /**
+     * @brief A member function that registers a counter kept by another component, e.g. the hits of a cache,
+     *        whose value is read when the metrics are rendered. Registering it again replaces the callback.
+     * @param name The name of the metric.
+     * @param help The help text of the metric.
+     * @param labels The labels of the series.
+     * @param read The callable returning the current value.
+     * @return The handle that keeps the counter registered; it must not outlive what read captures.
+     */
+    CallbackHandle counterCallback(const std::string& name, const std::string& help, const Labels& labels,
+                                   std::function<double()> read);
+
+    /**
+     * @brief A member function that renders every metric in the Prometheus text exposition format.
+     * @return The rendered metrics.
+     */
+    std::string render() const;
+};
+
+} // namespace metrics
+
+#endif // METRICS_HPP
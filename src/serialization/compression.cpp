@@ -0,0 +1,123 @@
+/**
+ * @file    compression.cpp
+ * @brief   This file contains the implementation of the Compressor class and the content negotiation helpers.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include "compression.hpp"
+
+namespace serialization {
+
+namespace {
+
+std::string_view trim(std::string_view text) {
+    std::size_t first = text.find_first_not_of(" \t");
+    if (first == std::string_view::npos) return {};
+    std::size_t last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+// The q parameter of one Accept-Encoding entry, 1 if it has none
+double quality(std::string_view parameters) {
+    while (!parameters.empty()) {
+        std::size_t end = parameters.find(';');
+        std::string_view parameter = trim(parameters.substr(0, end));
+        if (parameter.size() > 2 && (parameter[0] == 'q' || parameter[0] == 'Q') && parameter[1] == '=') {
+            return std::strtod(std::string(parameter.substr(2)).c_str(), nullptr);
+        }
+        if (end == std::string_view::npos) break;
+        parameters.remove_prefix(end + 1);
+    }
+    return 1.0;
+}
+
+} // namespace
+
+double acceptQuality(std::string_view header, std::string_view value) {
+    double result = -1.0;
+    while (!header.empty()) {
+        std::size_t end = header.find(',');
+        std::string_view entry = header.substr(0, end);
+        std::size_t semicolon = entry.find(';');
+        if (equalsIgnoreCase(trim(entry.substr(0, semicolon)), value)) {
+            result = std::max(result, semicolon == std::string_view::npos ? 1.0 : quality(entry.substr(semicolon + 1)));
+        }
+        if (end == std::string_view::npos) break;
+        header.remove_prefix(end + 1);
+    }
+    return result;
+}
+
+ContentEncoding negotiateEncoding(std::string_view accept_encoding) {
+    double wildcard = acceptQuality(accept_encoding, "*");
+    double gzip = std::max(acceptQuality(accept_encoding, "gzip"), acceptQuality(accept_encoding, "x-gzip"));
+    double deflate = acceptQuality(accept_encoding, "deflate");
+    if (gzip < 0) gzip = wildcard;
+    if (deflate < 0) deflate = wildcard;
+    if (gzip > 0 && gzip >= deflate) return ContentEncoding::Gzip;
+    if (deflate > 0) return ContentEncoding::Deflate;
+    return ContentEncoding::Identity;
+}
+
+const char* encodingName(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Gzip: return "gzip";
+        case ContentEncoding::Deflate: return "deflate";
+        default: return "identity";
+    }
+}
+
+Compressor::Compressor(ContentEncoding encoding, int level)
+    : initialized_(false) {
+    std::memset(&stream_, 0, sizeof(stream_));
+    // 15 bits of window for the zlib format, plus 16 for a gzip header and trailer instead
+    int window_bits = encoding == ContentEncoding::Gzip ? 15 + 16 : 15;
+    initialized_ = deflateInit2(&stream_, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+Compressor::~Compressor() {
+    if (initialized_) {
+        deflateEnd(&stream_);
+    }
+}
+
+bool Compressor::run(std::string_view input, int flush, std::string& out) {
+    if (!initialized_) {
+        return false;
+    }
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream_.avail_in = static_cast<uInt>(input.size());
+    int result;
+    do {
+        // Grows the output by the bound of what is left, so most bodies take a single deflate call
+        std::size_t offset = out.size();
+        std::size_t room = deflateBound(&stream_, stream_.avail_in) + 64;
+        out.resize(offset + room);
+        stream_.next_out = reinterpret_cast<Bytef*>(&out[offset]);
+        stream_.avail_out = static_cast<uInt>(room);
+        result = deflate(&stream_, flush);
+        out.resize(offset + room - stream_.avail_out);
+        if (result == Z_STREAM_ERROR) {
+            return false;
+        }
+    } while (stream_.avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+    return true;
+}
+
+bool compress(std::string_view input, ContentEncoding encoding, int level, std::string& out) {
+    out.clear();
+    Compressor compressor(encoding, level);
+    return compressor.write(input, out) && compressor.finish(out);
+}
+
+} // namespace serialization
@@ -0,0 +1,105 @@
+/**
+ * @file    compression.hpp
+ * @brief   This file contains the declaration of the Compressor class and the content negotiation helpers.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <zlib.h>
+#include <string>
+#include <string_view>
+
+namespace serialization {
+
+enum class ContentEncoding { Identity, Gzip, Deflate };
+
+/**
+ * @brief A function that returns the quality a client gives to a value in an Accept-style header.
+ * @param header The header value, e.g. "application/msgpack, application/json;q=0.5".
+ * @param value The value to look up, compared case-insensitively.
+ * @return The q parameter of the value, 1 if it has none, -1 if the header does not list it.
+ */
+double acceptQuality(std::string_view header, std::string_view value);
+
+/**
+ * @brief A function that picks the encoding of a response from the Accept-Encoding header of the request.
+ *        gzip is preferred over deflate when the client accepts both with the same quality.
+ * @param accept_encoding The header value, e.g. "gzip, deflate;q=0.5" or "*".
+ * @return The encoding, Identity if the client accepts neither.
+ */
+ContentEncoding negotiateEncoding(std::string_view accept_encoding);
+
+/**
+ * @brief A function that returns the Content-Encoding token of an encoding.
+ * @param encoding The encoding.
+ * @return "gzip", "deflate" or "identity".
+ */
+const char* encodingName(ContentEncoding encoding);
+
+/**
+ * @brief A streaming gzip or deflate (zlib format, as HTTP defines it) compressor. The compressed bytes
+ *        are appended to the caller's buffer, so a body can be sent in chunks as it is produced.
+ */
+class Compressor {
+private:
+    z_stream stream_;
+    bool initialized_;
+
+    /**
+     * @brief A member function that runs deflate over the input and appends its output.
+     * @param input The bytes to be compressed.
+     * @param flush Z_NO_FLUSH while the body continues, Z_FINISH for its last bytes.
+     * @param out The buffer the compressed bytes are appended to.
+     * @return True if deflate succeeded, false otherwise.
+     */
+    bool run(std::string_view input, int flush, std::string& out);
+
+public:
+    /**
+     * @brief A constructor for the Compressor class.
+     * @param encoding Gzip or Deflate.
+     * @param level The zlib compression level, from 1 (fastest) to 9 (smallest).
+     */
+    Compressor(ContentEncoding encoding, int level);
+
+    /**
+     * @brief A destructor for the Compressor class.
+     */
+    ~Compressor();
+
+    Compressor(const Compressor&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+
+    /**
+     * @brief A member function that compresses the next part of the body.
+     * @param input The bytes to be compressed.
+     * @param out The buffer the compressed bytes are appended to.
+     * @return True if the bytes were compressed, false otherwise.
+     */
+    bool write(std::string_view input, std::string& out) { return run(input, Z_NO_FLUSH, out); }
+
+    /**
+     * @brief A member function that ends the body, appending the buffered bytes and the trailer.
+     * @param out The buffer the compressed bytes are appended to.
+     * @return True if the body was finished, false otherwise.
+     */
+    bool finish(std::string& out) { return run({}, Z_FINISH, out); }
+};
+
+/**
+ * @brief A function that compresses a whole body.
+ * @param input The body.
+ * @param encoding Gzip or Deflate.
+ * @param level The zlib compression level, from 1 to 9.
+ * @param out Set to the compressed body.
+ * @return True if the body was compressed, false otherwise.
+ */
+bool compress(std::string_view input, ContentEncoding encoding, int level, std::string& out);
+
+} // namespace serialization
+
+#endif // COMPRESSION_HPP
@@ -0,0 +1,403 @@
+/**
+ * @file    json_reader.cpp
+ * @brief   This file contains the implementation of the JsonReader class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <charconv>
+#include <cstring>
+#include "json_reader.hpp"
+
+namespace serialization {
+
+// A field of the object readFields decodes; exactly one of text and number is set
+struct JsonField {
+    std::string_view key;
+    std::string* text;
+    int* number;
+    bool seen;
+};
+
+namespace {
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// The four hex digits after \u, which readRawString has already checked
+unsigned hex4(const char* digits) {
+    unsigned value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value = value << 4 | static_cast<unsigned>(hexValue(digits[i]));
+    }
+    return value;
+}
+
+void appendUtf8(std::string& out, unsigned code_point) {
+    if (code_point < 0x80) {
+        out.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        out.push_back(static_cast<char>(0xc0 | code_point >> 6));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    } else if (code_point < 0x10000) {
+        out.push_back(static_cast<char>(0xe0 | code_point >> 12));
+        out.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    } else {
+        out.push_back(static_cast<char>(0xf0 | code_point >> 18));
+        out.push_back(static_cast<char>(0x80 | (code_point >> 12 & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    }
+}
+
+} // namespace
+
+JsonReader::JsonReader(std::string_view data)
+    : begin_(data.data())
+    , pos_(data.data())
+    , end_(data.data() + data.size())
+    , broken_(false)
+    , first_element_(false) {}
+
+void JsonReader::skipWhitespace() {
+    while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r')) {
+        ++pos_;
+    }
+}
+
+bool JsonReader::syntaxError(const char* expected) {
+    if (!broken_) {
+        broken_ = true;
+        error_ = "Malformed JSON at offset " + std::to_string(pos_ - begin_) + ": expected " + expected + ".";
+    }
+    return false;
+}
+
+bool JsonReader::atEnd() {
+    skipWhitespace();
+    return pos_ == end_;
+}
+
+bool JsonReader::readRawString(std::string_view& raw, bool& escaped) {
+    if (pos_ == end_ || *pos_ != '"') {
+        return syntaxError("a string");
+    }
+    const char* start = ++pos_;
+    escaped = false;
+    while (pos_ < end_) {
+        unsigned char c = static_cast<unsigned char>(*pos_);
+        if (c == '"') {
+            raw = std::string_view(start, static_cast<std::size_t>(pos_ - start));
+            ++pos_;
+            return true;
+        }
+        if (c < 0x20) {
+            return syntaxError("no control character in a string");
+        }
+        if (c == '\\') {
+            escaped = true;
+            if (++pos_ == end_) break;
+            if (*pos_ == 'u') {
+                if (end_ - pos_ < 5 || hexValue(pos_[1]) < 0 || hexValue(pos_[2]) < 0 || hexValue(pos_[3]) < 0 ||
+                    hexValue(pos_[4]) < 0) {
+                    return syntaxError("four hex digits after \\u");
+                }
+                pos_ += 4;
+            } else if (!std::strchr("\"\\/bfnrt", *pos_) || *pos_ == '\0') {
+                return syntaxError("a valid escape");
+            }
+        }
+        ++pos_;
+    }
+    return syntaxError("'\"' closing the string");
+}
+
+bool JsonReader::readRawNumber(std::string_view& raw, bool& integer) {
+    const char* start = pos_;
+    integer = true;
+    if (pos_ < end_ && *pos_ == '-') ++pos_;
+    if (pos_ == end_ || !isDigit(*pos_)) {
+        return syntaxError("a digit");
+    }
+    if (*pos_ == '0') {
+        ++pos_;  // No leading zeros
+    } else {
+        while (pos_ < end_ && isDigit(*pos_)) ++pos_;
+    }
+    if (pos_ < end_ && *pos_ == '.') {
+        integer = false;
+        ++pos_;
+        if (pos_ == end_ || !isDigit(*pos_)) return syntaxError("a digit");
+        while (pos_ < end_ && isDigit(*pos_)) ++pos_;
+    }
+    if (pos_ < end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+        integer = false;
+        ++pos_;
+        if (pos_ < end_ && (*pos_ == '+' || *pos_ == '-')) ++pos_;
+        if (pos_ == end_ || !isDigit(*pos_)) return syntaxError("a digit");
+        while (pos_ < end_ && isDigit(*pos_)) ++pos_;
+    }
+    raw = std::string_view(start, static_cast<std::size_t>(pos_ - start));
+    return true;
+}
+
+bool JsonReader::skipValue(int depth) {
+    skipWhitespace();
+    if (pos_ == end_) {
+        return syntaxError("a value");
+    }
+    char c = *pos_;
+    if (c == '"') {
+        std::string_view raw;
+        bool escaped;
+        return readRawString(raw, escaped);
+    }
+    if (c == '-' || isDigit(c)) {
+        std::string_view raw;
+        bool integer;
+        return readRawNumber(raw, integer);
+    }
+    if (c == '{' || c == '[') {
+        if (depth >= kMaxDepth) {
+            return syntaxError("at most 32 levels of nesting");
+        }
+        char close = c == '{' ? '}' : ']';
+        ++pos_;
+        skipWhitespace();
+        if (pos_ < end_ && *pos_ == close) {
+            ++pos_;
+            return true;
+        }
+        while (true) {
+            if (c == '{') {
+                std::string_view key;
+                bool escaped;
+                skipWhitespace();
+                if (!readRawString(key, escaped)) return false;
+                skipWhitespace();
+                if (pos_ == end_ || *pos_ != ':') return syntaxError("':'");
+                ++pos_;
+            }
+            if (!skipValue(depth + 1)) return false;
+            skipWhitespace();
+            if (pos_ < end_ && *pos_ == ',') {
+                ++pos_;
+            } else if (pos_ < end_ && *pos_ == close) {
+                ++pos_;
+                return true;
+            } else {
+                return syntaxError(c == '{' ? "',' or '}'" : "',' or ']'");
+            }
+        }
+    }
+    for (std::string_view literal : { "true", "false", "null" }) {
+        if (static_cast<std::size_t>(end_ - pos_) >= literal.size() && std::string_view(pos_, literal.size()) == literal) {
+            pos_ += literal.size();
+            return true;
+        }
+    }
+    return syntaxError("a value");
+}
+
+bool JsonReader::decodeString(std::string_view raw, std::string& out) {
+    out.clear();
+    out.reserve(raw.size());
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\') {
+            out.push_back(raw[i]);
+            continue;
+        }
+        char escape = raw[++i];
+        switch (escape) {
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                unsigned code_point = hex4(&raw[i + 1]);
+                i += 4;
+                if (code_point >= 0xdc00 && code_point <= 0xdfff) {
+                    pos_ = raw.data() + i - 5;
+                    return syntaxError("a high surrogate before a low one");
+                }
+                if (code_point >= 0xd800 && code_point <= 0xdbff) {
+                    // Characters outside the BMP are escaped as a pair of surrogates
+                    unsigned low = 0;
+                    if (i + 6 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                        low = hex4(&raw[i + 3]);
+                    }
+                    if (low < 0xdc00 || low > 0xdfff) {
+                        pos_ = raw.data() + i + 1;
+                        return syntaxError("a low surrogate after a high one");
+                    }
+                    code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+                    i += 6;
+                }
+                appendUtf8(out, code_point);
+                break;
+            }
+            default: out.push_back(escape); break;  // '"', '\\' and '/'
+        }
+    }
+    return true;
+}
+
+bool JsonReader::readFields(JsonField* fields, std::size_t count, std::string& error) {
+    skipWhitespace();
+    if (pos_ == end_ || *pos_ != '{') {
+        error = skipValue(0) ? "Expected a JSON object." : error_;
+        return false;
+    }
+    ++pos_;
+    bool valid = true;
+    std::string decoded_key;  // Only used for keys holding escapes
+    for (bool first = true;; first = false) {
+        skipWhitespace();
+        if (first && pos_ < end_ && *pos_ == '}') {
+            ++pos_;
+            break;
+        }
+        std::string_view key;
+        bool escaped;
+        if (!readRawString(key, escaped)) break;
+        if (escaped) {
+            if (!decodeString(key, decoded_key)) break;
+            key = decoded_key;
+        }
+        skipWhitespace();
+        if (pos_ == end_ || *pos_ != ':') {
+            syntaxError("':'");
+            break;
+        }
+        ++pos_;
+        skipWhitespace();
+
+        JsonField* field = nullptr;
+        for (std::size_t f = 0; f < count; ++f) {
+            if (fields[f].key == key) field = &fields[f];
+        }
+        if (!field) {
+            if (!skipValue(1)) break;
+        } else if (field->seen) {
+            if (valid) error = "Duplicate " + std::string(field->key) + ".";
+            valid = false;
+            if (!skipValue(1)) break;
+        } else if (field->text && pos_ < end_ && *pos_ == '"') {
+            std::string_view raw;
+            if (!readRawString(raw, escaped)) break;
+            if (escaped) {
+                if (!decodeString(raw, *field->text)) break;
+            } else {
+                field->text->assign(raw.data(), raw.size());
+            }
+            field->seen = true;
+        } else if (field->number && pos_ < end_ && (*pos_ == '-' || isDigit(*pos_))) {
+            std::string_view raw;
+            bool integer;
+            if (!readRawNumber(raw, integer)) break;
+            int value = 0;
+            auto result = std::from_chars(raw.data(), raw.data() + raw.size(), value);
+            if (!integer || result.ec != std::errc()) {
+                if (valid) {
+                    error = "Invalid " + std::string(field->key) + (integer ? ": out of range." : ": expected an integer.");
+                }
+                valid = false;
+            } else {
+                *field->number = value;
+            }
+            field->seen = true;
+        } else {
+            if (valid) {
+                error = "Invalid " + std::string(field->key) + (field->text ? ": expected a string." : ": expected an integer.");
+            }
+            valid = false;
+            field->seen = true;
+            if (!skipValue(1)) break;
+        }
+
+        skipWhitespace();
+        if (pos_ < end_ && *pos_ == ',') {
+            ++pos_;
+        } else if (pos_ < end_ && *pos_ == '}') {
+            ++pos_;
+            break;
+        } else {
+            syntaxError("',' or '}'");
+            break;
+        }
+    }
+    if (broken_) {
+        error = error_;
+        return false;
+    }
+    for (std::size_t f = 0; f < count && valid; ++f) {
+        if (!fields[f].seen) {
+            error = "Missing " + std::string(fields[f].key) + ".";
+            valid = false;
+        }
+    }
+    return valid;
+}
+
+bool JsonReader::beginArray() {
+    skipWhitespace();
+    if (pos_ == end_ || *pos_ != '[') {
+        return syntaxError("'['");
+    }
+    ++pos_;
+    first_element_ = true;
+    return true;
+}
+
+bool JsonReader::nextElement() {
+    if (broken_) {
+        return false;
+    }
+    skipWhitespace();
+    if (pos_ < end_ && *pos_ == ']') {
+        ++pos_;  // A ']' right after a ',' never gets here: the element read after the ',' finds no value
+        first_element_ = false;
+        return false;
+    }
+    if (first_element_) {
+        first_element_ = false;
+        return true;  // An empty input is reported by the element read
+    }
+    if (pos_ < end_ && *pos_ == ',') {
+        ++pos_;
+        return true;
+    }
+    return syntaxError("',' or ']'");
+}
+
+bool JsonReader::readDevice(Device& device, std::string& error) {
+    JsonField fields[] = {
+        { "name", &device.name, nullptr, false },
+        { "type", &device.type, nullptr, false },
+        { "serial_number", &device.serial_number, nullptr, false },
+        { "creation_date", &device.creation_date, nullptr, false },
+        { "location_id", nullptr, &device.location_id, false },
+    };
+    return readFields(fields, sizeof(fields) / sizeof(fields[0]), error);
+}
+
+bool JsonReader::readLocation(Location& location, std::string& error) {
+    JsonField fields[] = {
+        { "name", &location.name, nullptr, false },
+        { "type", &location.type, nullptr, false },
+    };
+    return readFields(fields, sizeof(fields) / sizeof(fields[0]), error);
+}
+
+} // namespace serialization
@@ -0,0 +1,146 @@
+/**
+ * @file    json_reader.hpp
+ * @brief   This file contains the declaration of the JsonReader class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef JSON_READER_HPP
+#define JSON_READER_HPP
+
+#include <string>
+#include <string_view>
+#include "../utilities/metadata.hpp"
+
+namespace serialization {
+
+struct JsonField;
+
+/**
+ * @brief A strict JSON decoder for request bodies. Devices and locations are read straight from the caller's
+ *        buffer into their fields, without building an intermediate Json::Value tree; only strings holding
+ *        escapes are decoded through a copy.
+ */
+class JsonReader {
+private:
+    const char* begin_;
+    const char* pos_;
+    const char* end_;
+    bool broken_;        // The input is not valid JSON, nothing after the failure can be read
+    bool first_element_; // No element of the current array has been read yet
+    std::string error_;  // Why the input is not valid JSON
+
+    static constexpr int kMaxDepth = 32;  // Deeper values are rejected rather than recursed into
+
+    /**
+     * @brief A member function that moves past spaces, tabs and line breaks.
+     */
+    void skipWhitespace();
+
+    /**
+     * @brief A member function that fails the reader, recording where and why.
+     * @param expected What the input should have held at the current position.
+     * @return False.
+     */
+    bool syntaxError(const char* expected);
+
+    /**
+     * @brief A member function that reads a string without decoding it.
+     * @param raw Set to the bytes between the quotes.
+     * @param escaped Set to true if the string holds escapes and must be decoded.
+     * @return True if the next value is a valid string, false otherwise.
+     */
+    bool readRawString(std::string_view& raw, bool& escaped);
+
+    /**
+     * @brief A member function that reads a number without converting it.
+     * @param raw Set to the text of the number.
+     * @param integer Set to true if the number has neither a fraction nor an exponent.
+     * @return True if the next value is a valid number, false otherwise.
+     */
+    bool readRawNumber(std::string_view& raw, bool& integer);
+
+    /**
+     * @brief A member function that skips the next value, objects and arrays included.
+     * @param depth The number of objects and arrays the value is nested in.
+     * @return True if a whole value was skipped, false if the input is not valid JSON.
+     */
+    bool skipValue(int depth);
+
+    /**
+     * @brief A member function that decodes the escapes of a string read by readRawString.
+     * @param raw The bytes between the quotes.
+     * @param out Set to the decoded string, UTF-8 encoded.
+     * @return True if every escape is valid, false otherwise.
+     */
+    bool decodeString(std::string_view raw, std::string& out);
+
+    /**
+     * @brief A member function that reads an object into the fields of a device or a location.
+     * @param fields The fields, see json_reader.cpp.
+     * @param count The number of fields.
+     * @param error Set to the reason the object was rejected.
+     * @return True if the object holds every field with the right type, false otherwise.
+     */
+    bool readFields(JsonField* fields, std::size_t count, std::string& error);
+
+public:
+    /**
+     * @brief A constructor for the JsonReader class.
+     * @param data The JSON text, which must outlive the reader.
+     */
+    explicit JsonReader(std::string_view data);
+
+    /**
+     * @brief A member function that tells whether only whitespace is left.
+     * @return True if the whole input has been read.
+     */
+    bool atEnd();
+
+    /**
+     * @brief A member function that tells whether the input turned out not to be valid JSON.
+     * @return True if the reader failed; error() tells why.
+     */
+    bool broken() const { return broken_; }
+
+    /**
+     * @brief A member function that returns why the input is not valid JSON.
+     * @return The error, e.g. "Malformed JSON at offset 17: expected ':'.".
+     */
+    const std::string& error() const { return error_; }
+
+    /**
+     * @brief A member function that reads the opening bracket of an array.
+     * @return True if the next value is an array, false otherwise.
+     */
+    bool beginArray();
+
+    /**
+     * @brief A member function that moves to the next element of the array opened by beginArray.
+     * @return True if an element follows, false at the end of the array or if the input is not valid JSON.
+     */
+    bool nextElement();
+
+    /**
+     * @brief A member function that reads a device object. Unknown keys are skipped and "id" is ignored.
+     *        A field that is missing, repeated or of the wrong type fails the device but leaves the reader
+     *        after the object, so the next device of an array can still be read.
+     * @param device Set to the device.
+     * @param error Set to the reason the device was rejected.
+     * @return True if the object holds every field of a device with the right type, false otherwise.
+     */
+    bool readDevice(Device& device, std::string& error);
+
+    /**
+     * @brief A member function that reads a location object, like readDevice.
+     * @param location Set to the location.
+     * @param error Set to the reason the location was rejected.
+     * @return True if the object holds the name and the type of a location, false otherwise.
+     */
+    bool readLocation(Location& location, std::string& error);
+};
+
+} // namespace serialization
+
+#endif // JSON_READER_HPP
@@ -0,0 +1,135 @@
+/**
+ * @file    json_writer.cpp
+ * @brief   This file contains the implementation of the JsonWriter class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <charconv>
+#include "json_writer.hpp"
+
+namespace serialization {
+
+void JsonWriter::writeString(std::string_view value) {
+    static const char* hex = "0123456789abcdef";
+    buffer_.push_back('"');
+    // Copy runs of characters that need no escaping in one go
+    std::size_t run_start = 0;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        buffer_.append(value.data() + run_start, i - run_start);
+        run_start = i + 1;
+        switch (c) {
+            case '"': buffer_.append("\\\""); break;
+            case '\\': buffer_.append("\\\\"); break;
+            case '\b': buffer_.append("\\b"); break;
+            case '\f': buffer_.append("\\f"); break;
+            case '\n': buffer_.append("\\n"); break;
+            case '\r': buffer_.append("\\r"); break;
+            case '\t': buffer_.append("\\t"); break;
+            default:
+                buffer_.append("\\u00");
+                buffer_.push_back(hex[c >> 4]);
+                buffer_.push_back(hex[c & 0xF]);
+                break;
+        }
+    }
+    buffer_.append(value.data() + run_start, value.size() - run_start);
+    buffer_.push_back('"');
+}
+
+void JsonWriter::writeInt(long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer_.append(digits, result.ptr);
+}
+
+void JsonWriter::writeDevice(const Device& device) {
+    writeDevice(DeviceView{ device.id, device.name, device.type, device.serial_number, device.creation_date, device.location_id });
+}
+
+void JsonWriter::writeDevice(const DeviceView& device) {
+    buffer_.append("{\"id\":");
+    writeInt(device.id);
+    buffer_.append(",\"name\":");
+    writeString(device.name);
+    buffer_.append(",\"type\":");
+    writeString(device.type);
+    buffer_.append(",\"serial_number\":");
+    writeString(device.serial_number);
+    buffer_.append(",\"creation_date\":");
+    writeString(device.creation_date);
+    buffer_.append(",\"location_id\":");
+    writeInt(device.location_id);
+    buffer_.push_back('}');
+}
+
+void JsonWriter::writeLocation(const Location& location) {
+    buffer_.append("{\"id\":");
+    writeInt(location.id);
+    buffer_.append(",\"name\":");
+    writeString(location.name);
+    buffer_.append(",\"type\":");
+    writeString(location.type);
+    buffer_.push_back('}');
+}
+
+void JsonWriter::writeDevices(const std::vector<Device>& devices) {
+    buffer_.push_back('[');
+    for (std::size_t i = 0; i < devices.size(); ++i) {
+        if (i > 0) buffer_.push_back(',');
+        writeDevice(devices[i]);
+    }
+    buffer_.push_back(']');
+}
+
+void JsonWriter::writeLocations(const std::vector<Location>& locations) {
+    buffer_.push_back('[');
+    for (std::size_t i = 0; i < locations.size(); ++i) {
+        if (i > 0) buffer_.push_back(',');
+        writeLocation(locations[i]);
+    }
+    buffer_.push_back(']');
+}
+
+void JsonWriter::writeDeviceGroups(std::string_view key_name, const std::vector<DeviceGroup>& groups) {
+    buffer_.push_back('[');
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        if (i > 0) buffer_.push_back(',');
+        buffer_.push_back('{');
+        writeString(key_name);
+        buffer_.push_back(':');
+        writeString(groups[i].key);
+        if (key_name == "location") {
+            buffer_.append(",\"location_id\":");
+            writeInt(groups[i].location_id);
+        }
+        buffer_.append(",\"count\":");
+        writeInt(groups[i].count);
+        buffer_.push_back('}');
+    }
+    buffer_.push_back(']');
+}
+
+void JsonWriter::writeChanges(const std::vector<Change>& changes) {
+    buffer_.push_back('[');
+    for (std::size_t i = 0; i < changes.size(); ++i) {
+        if (i > 0) buffer_.push_back(',');
+        buffer_.append("{\"seq\":");
+        writeInt(static_cast<long long>(changes[i].seq));
+        buffer_.append(",\"entity\":");
+        writeString(changeEntityName(changes[i].entity));
+        buffer_.append(",\"id\":");
+        writeInt(changes[i].id);
+        buffer_.append(",\"operation\":");
+        writeString(changeOperationName(changes[i].operation));
+        buffer_.push_back('}');
+    }
+    buffer_.push_back(']');
+}
+
+} // namespace serialization
@@ -0,0 +1,116 @@
+/**
+ * @file    json_writer.hpp
+ * @brief   This file contains the declaration of the JsonWriter class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef JSON_WRITER_HPP
+#define JSON_WRITER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../utilities/metadata.hpp"
+
+namespace serialization {
+
+/**
+ * @brief A compact JSON serializer that writes Device and Location values straight into a reusable buffer,
+ *        without building an intermediate Json::Value tree.
+ */
+class JsonWriter {
+private:
+    std::string buffer_;
+
+public:
+    /**
+     * @brief A member function that empties the buffer while keeping its capacity for the next document.
+     */
+    void clear() { buffer_.clear(); }
+
+    /**
+     * @brief A member function that returns the number of bytes written so far.
+     * @return The buffer size.
+     */
+    std::size_t size() const { return buffer_.size(); }
+
+    /**
+     * @brief A member function that returns the serialized document.
+     * @return The buffer contents.
+     */
+    const std::string& str() const { return buffer_; }
+
+    /**
+     * @brief A member function that appends raw, already valid JSON text.
+     * @param text The text to be appended.
+     */
+    void append(std::string_view text) { buffer_.append(text); }
+
+    /**
+     * @brief A member function that appends a single raw character, e.g. a separator.
+     * @param c The character to be appended.
+     */
+    void append(char c) { buffer_.push_back(c); }
+
+    /**
+     * @brief A member function that writes a quoted and escaped JSON string.
+     * @param value The string to be written.
+     */
+    void writeString(std::string_view value);
+
+    /**
+     * @brief A member function that writes a JSON integer.
+     * @param value The integer to be written.
+     */
+    void writeInt(long long value);
+
+    /**
+     * @brief A member function that writes a device as a JSON object.
+     * @param device The device to be written.
+     */
+    void writeDevice(const Device& device);
+
+    /**
+     * @brief A member function that writes a device row as a JSON object without copying its fields.
+     * @param device The device row to be written.
+     */
+    void writeDevice(const DeviceView& device);
+
+    /**
+     * @brief A member function that writes a location as a JSON object.
+     * @param location The location to be written.
+     */
+    void writeLocation(const Location& location);
+
+    /**
+     * @brief A member function that writes devices as a JSON array.
+     * @param devices The devices to be written.
+     */
+    void writeDevices(const std::vector<Device>& devices);
+
+    /**
+     * @brief A member function that writes locations as a JSON array.
+     * @param locations The locations to be written.
+     */
+    void writeLocations(const std::vector<Location>& locations);
+
+    /**
+     * @brief A member function that writes device counts as a JSON array of {"<key_name>": key, "count": n} objects.
+     *        Groups by location also hold their "location_id".
+     * @param key_name The name of the grouping column, e.g. "type".
+     * @param groups The groups to be written.
+     */
+    void writeDeviceGroups(std::string_view key_name, const std::vector<DeviceGroup>& groups);
+
+    /**
+     * @brief A member function that writes changes as a JSON array of {"seq", "entity", "id", "operation"} objects.
+     * @param changes The changes to be written.
+     */
+    void writeChanges(const std::vector<Change>& changes);
+};
+
+} // namespace serialization
+
+#endif // JSON_WRITER_HPP
@@ -0,0 +1,389 @@
+/**
+ * @file    msgpack.cpp
+ * @brief   This file contains the implementation of the MsgpackWriter and MsgpackReader classes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <limits>
+#include "msgpack.hpp"
+
+namespace serialization {
+
+namespace {
+
+// Keys are written as fixstr, the type byte holding the length
+void writeKey(std::string& buffer, std::string_view key) {
+    buffer.push_back(static_cast<char>(0xa0 | key.size()));
+    buffer.append(key);
+}
+
+// Reads the fields of a map into the given slots, in any order; other keys are skipped, repeated ones rejected
+struct Field {
+    std::string_view key;
+    std::string* text;     // Set for string fields
+    int* number;           // Set for integer fields
+    bool seen;
+};
+
+bool readFields(MsgpackReader& reader, Field* fields, std::size_t count, std::string& error) {
+    std::size_t size;
+    if (!reader.readMapHeader(size)) {
+        error = "Expected a map.";
+        reader.skip();
+        return false;
+    }
+    bool valid = true;
+    for (std::size_t i = 0; i < size; ++i) {
+        std::string_view key;
+        if (!reader.readString(key)) {
+            if (!reader.skip() || !reader.skip()) break;  // Non-string key and its value
+            continue;
+        }
+        Field* field = nullptr;
+        for (std::size_t f = 0; f < count; ++f) {
+            if (fields[f].key == key) field = &fields[f];
+        }
+        if (!field) {
+            if (!reader.skip()) break;
+            continue;
+        }
+        if (field->seen) {
+            if (valid) error = "Duplicate " + std::string(field->key) + ".";
+            valid = false;
+            if (!reader.skip()) break;
+            continue;
+        }
+        std::string_view text;
+        long long number;
+        if (field->text && reader.readString(text)) {
+            field->text->assign(text);
+            field->seen = true;
+        } else if (field->number && reader.readInt(number)) {
+            if (number < std::numeric_limits<int>::min() || number > std::numeric_limits<int>::max()) {
+                if (valid) error = "Invalid " + std::string(key) + ".";
+                valid = false;
+            } else {
+                *field->number = static_cast<int>(number);
+            }
+            field->seen = true;
+        } else {
+            if (valid) error = "Invalid " + std::string(key) + ".";
+            valid = false;
+            if (!reader.skip()) break;
+        }
+    }
+    if (reader.broken()) {
+        error = "Truncated body.";
+        return false;
+    }
+    for (std::size_t f = 0; f < count && valid; ++f) {
+        if (!fields[f].seen) {
+            error = "Missing " + std::string(fields[f].key) + ".";
+            valid = false;
+        }
+    }
+    return valid;
+}
+
+} // namespace
+
+void MsgpackWriter::writeTagged(unsigned char type, std::uint64_t value, int bytes) {
+    buffer_.push_back(static_cast<char>(type));
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+        buffer_.push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+}
+
+void MsgpackWriter::writeArrayHeader(std::size_t size) {
+    if (size < 16) buffer_.push_back(static_cast<char>(0x90 | size));
+    else if (size <= 0xffff) writeTagged(0xdc, size, 2);
+    else writeTagged(0xdd, size, 4);
+}
+
+void MsgpackWriter::writeMapHeader(std::size_t size) {
+    if (size < 16) buffer_.push_back(static_cast<char>(0x80 | size));
+    else if (size <= 0xffff) writeTagged(0xde, size, 2);
+    else writeTagged(0xdf, size, 4);
+}
+
+void MsgpackWriter::writeString(std::string_view value) {
+    std::size_t size = value.size();
+    if (size < 32) buffer_.push_back(static_cast<char>(0xa0 | size));
+    else if (size <= 0xff) writeTagged(0xd9, size, 1);
+    else if (size <= 0xffff) writeTagged(0xda, size, 2);
+    else writeTagged(0xdb, size, 4);
+    buffer_.append(value);
+}
+
+void MsgpackWriter::writeInt(long long value) {
+    if (value >= 0) {
+        if (value < 128) buffer_.push_back(static_cast<char>(value));
+        else if (value <= 0xff) writeTagged(0xcc, value, 1);
+        else if (value <= 0xffff) writeTagged(0xcd, value, 2);
+        else if (value <= 0xffffffffLL) writeTagged(0xce, value, 4);
+        else writeTagged(0xcf, value, 8);
+    } else {
+        std::uint64_t bits = static_cast<std::uint64_t>(value);
+        if (value >= -32) buffer_.push_back(static_cast<char>(value));
+        else if (value >= -128) writeTagged(0xd0, bits, 1);
+        else if (value >= -32768) writeTagged(0xd1, bits, 2);
+        else if (value >= -2147483648LL) writeTagged(0xd2, bits, 4);
+        else writeTagged(0xd3, bits, 8);
+    }
+}
+
+void MsgpackWriter::writeDevice(const Device& device) {
+    writeDevice(DeviceView{ device.id, device.name, device.type, device.serial_number, device.creation_date, device.location_id });
+}
+
+void MsgpackWriter::writeDevice(const DeviceView& device) {
+    buffer_.push_back(static_cast<char>(0x86));  // fixmap of 6 pairs
+    writeKey(buffer_, "id");
+    writeInt(device.id);
+    writeKey(buffer_, "name");
+    writeString(device.name);
+    writeKey(buffer_, "type");
+    writeString(device.type);
+    writeKey(buffer_, "serial_number");
+    writeString(device.serial_number);
+    writeKey(buffer_, "creation_date");
+    writeString(device.creation_date);
+    writeKey(buffer_, "location_id");
+    writeInt(device.location_id);
+}
+
+void MsgpackWriter::writeLocation(const Location& location) {
+    buffer_.push_back(static_cast<char>(0x83));  // fixmap of 3 pairs
+    writeKey(buffer_, "id");
+    writeInt(location.id);
+    writeKey(buffer_, "name");
+    writeString(location.name);
+    writeKey(buffer_, "type");
+    writeString(location.type);
+}
+
+void MsgpackWriter::writeDevices(const std::vector<Device>& devices) {
+    writeArrayHeader(devices.size());
+    for (const auto& device : devices) {
+        writeDevice(device);
+    }
+}
+
+void MsgpackWriter::writeLocations(const std::vector<Location>& locations) {
+    writeArrayHeader(locations.size());
+    for (const auto& location : locations) {
+        writeLocation(location);
+    }
+}
+
+void MsgpackWriter::writeDeviceGroups(std::string_view key_name, const std::vector<DeviceGroup>& groups) {
+    bool by_location = key_name == "location";
+    writeArrayHeader(groups.size());
+    for (const auto& group : groups) {
+        writeMapHeader(by_location ? 3 : 2);
+        writeString(key_name);
+        writeString(group.key);
+        if (by_location) {
+            writeKey(buffer_, "location_id");
+            writeInt(group.location_id);
+        }
+        writeKey(buffer_, "count");
+        writeInt(group.count);
+    }
+}
+
+void MsgpackWriter::writeChanges(const std::vector<Change>& changes) {
+    writeArrayHeader(changes.size());
+    for (const auto& change : changes) {
+        writeMapHeader(4);
+        writeKey(buffer_, "seq");
+        writeInt(static_cast<long long>(change.seq));
+        writeKey(buffer_, "entity");
+        writeString(changeEntityName(change.entity));
+        writeKey(buffer_, "id");
+        writeInt(change.id);
+        writeKey(buffer_, "operation");
+        writeString(changeOperationName(change.operation));
+    }
+}
+
+MsgpackReader::MsgpackReader(std::string_view data)
+    : pos_(reinterpret_cast<const unsigned char*>(data.data()))
+    , end_(reinterpret_cast<const unsigned char*>(data.data()) + data.size())
+    , broken_(false)
+    , depth_(0) {}
+
+bool MsgpackReader::readBigEndian(int bytes, std::uint64_t& value) {
+    if (end_ - pos_ < bytes) {
+        return fail();
+    }
+    value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | *pos_++;
+    }
+    return true;
+}
+
+bool MsgpackReader::readContainerHeader(unsigned char fix_mask, unsigned char type16, std::size_t& size) {
+    if (broken_ || pos_ == end_) {
+        return fail();
+    }
+    unsigned char type = *pos_;
+    std::uint64_t value;
+    if ((type & 0xf0) == fix_mask) {
+        ++pos_;
+        size = type & 0x0f;
+        return true;
+    }
+    if (type != type16 && type != type16 + 1) {
+        return false;
+    }
+    ++pos_;
+    if (!readBigEndian(type == type16 ? 2 : 4, value)) {
+        return false;
+    }
+    size = static_cast<std::size_t>(value);
+    return true;
+}
+
+bool MsgpackReader::readString(std::string_view& value) {
+    if (broken_ || pos_ == end_) {
+        return fail();
+    }
+    const unsigned char* start = pos_;
+    unsigned char type = *pos_;
+    std::uint64_t size;
+    if ((type & 0xe0) == 0xa0) {
+        ++pos_;
+        size = type & 0x1f;
+    } else if (type >= 0xd9 && type <= 0xdb) {
+        ++pos_;
+        if (!readBigEndian(1 << (type - 0xd9), size)) return false;
+    } else {
+        return false;
+    }
+    if (static_cast<std::uint64_t>(end_ - pos_) < size) {
+        pos_ = start;
+        return fail();
+    }
+    value = std::string_view(reinterpret_cast<const char*>(pos_), static_cast<std::size_t>(size));
+    pos_ += size;
+    return true;
+}
+
+bool MsgpackReader::readInt(long long& value) {
+    if (broken_ || pos_ == end_) {
+        return fail();
+    }
+    unsigned char type = *pos_;
+    std::uint64_t bits;
+    if (type <= 0x7f) {
+        value = type;
+    } else if (type >= 0xe0) {
+        value = static_cast<signed char>(type);
+    } else if (type >= 0xcc && type <= 0xcf) {
+        ++pos_;
+        if (!readBigEndian(1 << (type - 0xcc), bits)) return false;
+        if (bits > static_cast<std::uint64_t>(std::numeric_limits<long long>::max())) {
+            pos_ -= 9;  // Only a uint64 can overflow; the reader stays on it
+            return false;
+        }
+        value = static_cast<long long>(bits);
+        return true;
+    } else if (type >= 0xd0 && type <= 0xd3) {
+        ++pos_;
+        int bytes = 1 << (type - 0xd0);
+        if (!readBigEndian(bytes, bits)) return false;
+        int unused = 64 - bytes * 8;
+        value = unused == 0 ? static_cast<long long>(bits)
+                            : static_cast<long long>(bits << unused) >> unused;  // Sign-extends
+        return true;
+    } else {
+        return false;
+    }
+    ++pos_;
+    return true;
+}
+
+bool MsgpackReader::skip() {
+    if (broken_ || pos_ == end_) {
+        return fail();
+    }
+    unsigned char type = *pos_++;
+    std::uint64_t size = 0;
+    std::uint64_t entries = 0;  // Values nested in a container
+    if (type <= 0x7f || type >= 0xe0 || (type >= 0xc0 && type <= 0xc3)) {
+        return true;  // fixint, nil, bool
+    } else if ((type & 0xe0) == 0xa0) {
+        size = type & 0x1f;
+    } else if ((type & 0xf0) == 0x80) {
+        entries = 2 * (type & 0x0f);
+    } else if ((type & 0xf0) == 0x90) {
+        entries = type & 0x0f;
+    } else {
+        switch (type) {
+            case 0xc4: case 0xd9: if (!readBigEndian(1, size)) return false; break;  // bin8, str8
+            case 0xc5: case 0xda: if (!readBigEndian(2, size)) return false; break;
+            case 0xc6: case 0xdb: if (!readBigEndian(4, size)) return false; break;
+            case 0xc7: if (!readBigEndian(1, size)) return false; size += 1; break;  // ext: type byte follows the length
+            case 0xc8: if (!readBigEndian(2, size)) return false; size += 1; break;
+            case 0xc9: if (!readBigEndian(4, size)) return false; size += 1; break;
+            case 0xca: size = 4; break;  // float32
+            case 0xcb: size = 8; break;  // float64
+            case 0xcc: case 0xd0: size = 1; break;
+            case 0xcd: case 0xd1: size = 2; break;
+            case 0xce: case 0xd2: size = 4; break;
+            case 0xcf: case 0xd3: size = 8; break;
+            case 0xd4: size = 2; break;  // fixext: type byte and 1-16 bytes
+            case 0xd5: size = 3; break;
+            case 0xd6: size = 5; break;
+            case 0xd7: size = 9; break;
+            case 0xd8: size = 17; break;
+            case 0xdc: if (!readBigEndian(2, entries)) return false; break;
+            case 0xdd: if (!readBigEndian(4, entries)) return false; break;
+            case 0xde: if (!readBigEndian(2, entries)) return false; entries *= 2; break;
+            case 0xdf: if (!readBigEndian(4, entries)) return false; entries *= 2; break;
+            default: return fail();  // 0xc1 is never used
+        }
+    }
+    if (static_cast<std::uint64_t>(end_ - pos_) < size) {
+        return fail();
+    }
+    pos_ += size;
+    if (entries == 0) {
+        return true;
+    }
+    // Every nested value takes at least one byte, which bounds the loop by the input size
+    if (entries > static_cast<std::uint64_t>(end_ - pos_) || depth_ >= kMaxDepth) {
+        return fail();
+    }
+    ++depth_;
+    for (std::uint64_t i = 0; i < entries && !broken_; ++i) {
+        skip();
+    }
+    --depth_;
+    return !broken_;
+}
+
+bool MsgpackReader::readDevice(Device& device, std::string& error) {
+    Field fields[] = {
+        { "name", &device.name, nullptr, false },
+        { "type", &device.type, nullptr, false },
+        { "serial_number", &device.serial_number, nullptr, false },
+        { "creation_date", &device.creation_date, nullptr, false },
+        { "location_id", nullptr, &device.location_id, false },
+    };
+    return readFields(*this, fields, sizeof(fields) / sizeof(fields[0]), error);
+}
+
+bool MsgpackReader::readLocation(Location& location, std::string& error) {
+    Field fields[] = {
+        { "name", &location.name, nullptr, false },
+        { "type", &location.type, nullptr, false },
+    };
+    return readFields(*this, fields, sizeof(fields) / sizeof(fields[0]), error);
+}
+
+} // namespace serialization
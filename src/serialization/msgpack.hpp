@@ -0,0 +1,231 @@
+/**
+ * @file    msgpack.hpp
+ * @brief   This file contains the declaration of the MsgpackWriter and MsgpackReader classes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef MSGPACK_HPP
+#define MSGPACK_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../utilities/metadata.hpp"
+
+namespace serialization {
+
+/**
+ * @brief A MessagePack serializer that writes Device and Location values straight into a reusable buffer.
+ *        Values are maps keyed by the same field names as the JSON bodies, so clients decode both the same way.
+ */
+class MsgpackWriter {
+private:
+    std::string buffer_;
+
+    /**
+     * @brief A member function that writes a type byte followed by a big-endian value of the given width.
+     * @param type The type byte.
+     * @param value The value.
+     * @param bytes The width of the value in bytes: 1, 2, 4 or 8.
+     */
+    void writeTagged(unsigned char type, std::uint64_t value, int bytes);
+
+public:
+    /**
+     * @brief A member function that empties the buffer while keeping its capacity for the next document.
+     */
+    void clear() { buffer_.clear(); }
+
+    /**
+     * @brief A member function that returns the number of bytes written so far.
+     * @return The buffer size.
+     */
+    std::size_t size() const { return buffer_.size(); }
+
+    /**
+     * @brief A member function that returns the serialized document.
+     * @return The buffer contents.
+     */
+    const std::string& str() const { return buffer_; }
+
+    /**
+     * @brief A member function that writes the header of an array; its elements follow.
+     * @param size The number of elements.
+     */
+    void writeArrayHeader(std::size_t size);
+
+    /**
+     * @brief A member function that writes the header of a map; its keys and values follow in turn.
+     * @param size The number of key/value pairs.
+     */
+    void writeMapHeader(std::size_t size);
+
+    /**
+     * @brief A member function that writes a UTF-8 string.
+     * @param value The string to be written.
+     */
+    void writeString(std::string_view value);
+
+    /**
+     * @brief A member function that writes an integer in its smallest encoding.
+     * @param value The integer to be written.
+     */
+    void writeInt(long long value);
+
+    /**
+     * @brief A member function that writes a device as a map.
+     * @param device The device to be written.
+     */
+    void writeDevice(const Device& device);
+
+    /**
+     * @brief A member function that writes a device row as a map without copying its fields.
+     * @param device The device row to be written.
+     */
+    void writeDevice(const DeviceView& device);
+
+    /**
+     * @brief A member function that writes a location as a map.
+     * @param location The location to be written.
+     */
+    void writeLocation(const Location& location);
+
+    /**
+     * @brief A member function that writes devices as an array of maps.
+     * @param devices The devices to be written.
+     */
+    void writeDevices(const std::vector<Device>& devices);
+
+    /**
+     * @brief A member function that writes locations as an array of maps.
+     * @param locations The locations to be written.
+     */
+    void writeLocations(const std::vector<Location>& locations);
+
+    /**
+     * @brief A member function that writes device counts as an array of maps, with the keys of the JSON body.
+     * @param key_name The name of the grouping column, e.g. "type".
+     * @param groups The groups to be written.
+     */
+    void writeDeviceGroups(std::string_view key_name, const std::vector<DeviceGroup>& groups);
+
+    /**
+     * @brief A member function that writes changes as an array of maps, with the keys of the JSON body.
+     * @param changes The changes to be written.
+     */
+    void writeChanges(const std::vector<Change>& changes);
+};
+
+/**
+ * @brief A MessagePack decoder for request bodies. It reads from the caller's buffer without copying it;
+ *        strings are returned as views into that buffer.
+ */
+class MsgpackReader {
+private:
+    const unsigned char* pos_;
+    const unsigned char* end_;
+    bool broken_;  // The input is truncated or malformed, nothing after the failure can be read
+    int depth_;    // Containers skip() is inside of
+
+    static constexpr int kMaxDepth = 32;  // Deeper bodies are rejected rather than recursed into
+
+    /**
+     * @brief A member function that reads a big-endian unsigned value of the given width.
+     * @param bytes The width of the value in bytes.
+     * @param value Set to the value.
+     * @return True if the input holds the bytes, false otherwise.
+     */
+    bool readBigEndian(int bytes, std::uint64_t& value);
+
+    /**
+     * @brief A member function that reads the header of a container.
+     * @param fix_mask The type bits of the fix variant, 0x80 for maps and 0x90 for arrays.
+     * @param type16 The type byte of the 16-bit variant.
+     * @param size Set to the number of entries.
+     * @return True if the next value is a container of that kind, false otherwise.
+     */
+    bool readContainerHeader(unsigned char fix_mask, unsigned char type16, std::size_t& size);
+
+    /**
+     * @brief A member function that fails the reader and returns false.
+     */
+    bool fail() { broken_ = true; return false; }
+
+public:
+    /**
+     * @brief A constructor for the MsgpackReader class.
+     * @param data The encoded bytes, which must outlive the reader and the strings it returns.
+     */
+    explicit MsgpackReader(std::string_view data);
+
+    /**
+     * @brief A member function that tells whether the whole input has been read.
+     * @return True if no bytes are left.
+     */
+    bool atEnd() const { return pos_ == end_; }
+
+    /**
+     * @brief A member function that tells whether the input turned out to be truncated or malformed.
+     * @return True if the reader failed.
+     */
+    bool broken() const { return broken_; }
+
+    /**
+     * @brief A member function that reads the header of an array.
+     * @param size Set to the number of elements.
+     * @return True if the next value is an array, false otherwise.
+     */
+    bool readArrayHeader(std::size_t& size) { return readContainerHeader(0x90, 0xdc, size); }
+
+    /**
+     * @brief A member function that reads the header of a map.
+     * @param size Set to the number of key/value pairs.
+     * @return True if the next value is a map, false otherwise.
+     */
+    bool readMapHeader(std::size_t& size) { return readContainerHeader(0x80, 0xde, size); }
+
+    /**
+     * @brief A member function that reads a string. The reader does not move if the next value is not a string.
+     * @param value Set to a view of the string in the input.
+     * @return True if the next value is a string, false otherwise.
+     */
+    bool readString(std::string_view& value);
+
+    /**
+     * @brief A member function that reads an integer. The reader does not move if the next value is not an integer.
+     * @param value Set to the integer.
+     * @return True if the next value is an integer that fits, false otherwise.
+     */
+    bool readInt(long long& value);
+
+    /**
+     * @brief A member function that skips the next value, containers included.
+     * @return True if a whole value was skipped, false if the input is malformed.
+     */
+    bool skip();
+
+    /**
+     * @brief A member function that reads a device map. Unknown keys are skipped and "id" is ignored.
+     *        A field of the wrong type, or repeated, fails the device but leaves the reader after the map,
+     *        so the next device of an array can still be read.
+     * @param device Set to the device.
+     * @param error Set to the reason the device was rejected.
+     * @return True if the map holds every field of a device with the right type, false otherwise.
+     */
+    bool readDevice(Device& device, std::string& error);
+
+    /**
+     * @brief A member function that reads a location map, like readDevice.
+     * @param location Set to the location.
+     * @param error Set to the reason the location was rejected.
+     * @return True if the map holds the name and the type of a location, false otherwise.
+     */
+    bool readLocation(Location& location, std::string& error);
+};
+
+} // namespace serialization
+
+#endif // MSGPACK_HPP
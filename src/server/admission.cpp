@@ -0,0 +1,66 @@
+/**
+ * @file    admission.cpp
+ * @brief   This file contains the implementation of the AdmissionGate class.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include "../metrics/metrics.hpp"
+#include "../tracing/trace.hpp"
+#include "admission.hpp"
+
+namespace server {
+
+AdmissionGate::AdmissionGate(const std::string& name, int limit, int queue_limit, std::chrono::milliseconds queue_timeout)
+    : name_(name)
+    , limit_(limit)
+    , queue_limit_(queue_limit)
+    , queue_timeout_(queue_timeout)
+    , active_(0)
+    , waiting_(0) {
+    metrics::Registry& registry = metrics::Registry::global();
+    const char* shed_help = "Requests answered with 503 by admission control, by route class and reason";
+    shed_queue_full_ = &registry.counter("http_admission_shed_total", shed_help, { { "class", name }, { "reason", "queue_full" } });
+    shed_timeout_ = &registry.counter("http_admission_shed_total", shed_help, { { "class", name }, { "reason", "timeout" } });
+    active_gauge_ = registry.gauge("http_admission_active", "Requests running, by route class", { { "class", name } }, [this] {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return static_cast<double>(active_);
+    });
+    waiting_gauge_ = registry.gauge("http_admission_waiting", "Requests waiting for admission, by route class", { { "class", name } }, [this] {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return static_cast<double>(waiting_);
+    });
+}
+
+AdmissionGate::Ticket AdmissionGate::enter() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (active_ < limit_) {
+        ++active_;
+        return Ticket(this);
+    }
+    if (waiting_ >= queue_limit_) {
+        shed_queue_full_->add();
+        return Ticket(nullptr);
+    }
+    tracing::ScopedSpan span("admission_wait", "server");
+    ++waiting_;
+    bool admitted = available_.wait_for(lock, queue_timeout_, [this] { return active_ < limit_; });
+    --waiting_;
+    if (!admitted) {
+        shed_timeout_->add();
+        return Ticket(nullptr);
+    }
+    ++active_;
+    return Ticket(this);
+}
+
+void AdmissionGate::release() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --active_;
+    }
+    available_.notify_one();
+}
+
+} // namespace server
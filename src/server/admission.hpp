@@ -0,0 +1,97 @@
+/**
+ * @file    admission.hpp
+ * @brief   This file contains the declaration of the AdmissionGate class, which bounds the concurrency of a class of routes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef ADMISSION_HPP
+#define ADMISSION_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include "../metrics/metrics.hpp"
+
+namespace server {
+
+/**
+ * @brief Admission control for one class of routes: at most limit requests run at once and at most queue_limit
+ *        wait for a slot, each for at most the queue timeout. Requests beyond that are shed, so the worker
+ *        threads stay available for the other classes instead of piling up behind an expensive query.
+ */
+class AdmissionGate {
+private:
+    std::string name_;
+    int limit_;
+    int queue_limit_;
+    std::chrono::milliseconds queue_timeout_;
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    int active_;
+    int waiting_;
+    metrics::Counter* shed_queue_full_;
+    metrics::Counter* shed_timeout_;
+    metrics::CallbackHandle active_gauge_;   // Declared last: the gauges read mutex_, so they go away first
+    metrics::CallbackHandle waiting_gauge_;
+
+    /**
+     * @brief A member function that frees the slot of a finished request.
+     */
+    void release();
+
+public:
+    /**
+     * @brief An RAII handle on an admitted request's slot, freed when the ticket goes out of scope.
+     */
+    class Ticket {
+    private:
+        AdmissionGate* gate_;
+
+    public:
+        explicit Ticket(AdmissionGate* gate) : gate_(gate) {}
+
+        ~Ticket() {
+            if (gate_) {
+                gate_->release();
+            }
+        }
+
+        Ticket(Ticket&& other) noexcept : gate_(other.gate_) {
+            other.gate_ = nullptr;
+        }
+
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+        Ticket& operator=(Ticket&&) = delete;
+
+        explicit operator bool() const { return gate_ != nullptr; }
+    };
+
+    /**
+     * @brief A constructor for the AdmissionGate class. Registers its metrics under the class label; the gauges
+     *        are removed again when the gate is destroyed.
+     * @param name The name of the route class, e.g. "query".
+     * @param limit The number of requests of the class running at once.
+     * @param queue_limit The number of requests of the class waiting for a slot, 0 to shed as soon as the class is full.
+     * @param queue_timeout How long a waiting request may wait before it is shed.
+     */
+    AdmissionGate(const std::string& name, int limit, int queue_limit, std::chrono::milliseconds queue_timeout);
+
+    AdmissionGate(const AdmissionGate&) = delete;
+    AdmissionGate& operator=(const AdmissionGate&) = delete;
+
+    /**
+     * @brief A member function that admits a request, waiting for a slot if the class is full and the queue is not.
+     * @return The ticket of the request, an empty ticket if the request is shed.
+     */
+    Ticket enter();
+
+    const std::string& name() const { return name_; }
+};
+
+} // namespace server
+
+#endif // ADMISSION_HPP
@@ -0,0 +1,68 @@
+/**
+ * @file    response_cache.cpp
+ * @brief   This file contains the implementation of the rendered response cache used by the listing routes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <algorithm>
+#include <chrono>
+#include "response_cache.hpp"
+
+namespace server {
+
+void RenderedResponse::applyTo(served::response& res) const {
+    res.set_status(status);
+    for (const auto& header : headers) {
+        res.set_header(header.first, header.second);
+    }
+    if (!body.empty()) {
+        res.set_body(body);
+    }
+}
+
+std::string responseCacheKey(const std::string& path, const served::request& req) {
+    std::vector<std::pair<std::string, std::string>> params(req.query.begin(), req.query.end());
+    std::sort(params.begin(), params.end());
+    std::string key = path;
+    char separator = '?';
+    for (const auto& param : params) {
+        key += separator;
+        key += param.first;
+        key += '=';
+        key += param.second;
+        separator = '&';
+    }
+    return key;
+}
+
+std::string makeEtag(std::uint64_t version, const std::string& variant) {
+    static const std::string epoch = std::to_string(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    // Each content coding is a different representation, so it needs its own strong tag
+    return "\"" + epoch + "-" + std::to_string(version) + (variant.empty() ? "" : "-" + variant) + "\"";
+}
+
+bool etagMatches(const std::string& if_none_match, const std::string& etag) {
+    std::size_t start = 0;
+    while (start < if_none_match.size()) {
+        std::size_t end = if_none_match.find(',', start);
+        if (end == std::string::npos) end = if_none_match.size();
+        std::size_t first = if_none_match.find_first_not_of(" \t", start);
+        std::size_t last = if_none_match.find_last_not_of(" \t", end - 1);
+        if (first != std::string::npos && first < end) {
+            std::string candidate = if_none_match.substr(first, last - first + 1);
+            if (candidate.compare(0, 2, "W/") == 0) {
+                candidate.erase(0, 2);  // If-None-Match uses the weak comparison
+            }
+            if (candidate == "*" || candidate == etag) {
+                return true;
+            }
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+} // namespace server
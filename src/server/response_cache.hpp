@@ -0,0 +1,74 @@
+/**
+ * @file    response_cache.hpp
+ * @brief   This file contains the declaration of the rendered response cache used by the listing routes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef RESPONSE_CACHE_HPP
+#define RESPONSE_CACHE_HPP
+
+#include <served/served.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../database/lru_cache.hpp"
+
+namespace server {
+
+/**
+ * @brief A response rendered once and replayed for every request with the same query while the data version
+ *        is unchanged. It offers the subset of the served::response interface the listing handlers use.
+ */
+struct RenderedResponse {
+    std::uint64_t version = 0;  // Data version the response was rendered at
+    int status = 0;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+
+    void set_status(int status_code) { status = status_code; }
+
+    void set_header(const std::string& name, const std::string& value) { headers.emplace_back(name, value); }
+
+    void set_body(const std::string& content) { body = content; }
+
+    /**
+     * @brief A member function that copies the rendered status, headers and body into a served response.
+     * @param res The response object.
+     */
+    void applyTo(served::response& res) const;
+};
+
+using ResponseCache = database::LruCache<std::string, std::shared_ptr<const RenderedResponse>>;
+
+/**
+ * @brief A function that builds the cache key of a request from its path and its query parameters in sorted order.
+ * @param path The route of the request.
+ * @param req The request object.
+ * @return The cache key.
+ */
+std::string responseCacheKey(const std::string& path, const served::request& req);
+
+/**
+ * @brief A function that builds the entity tag of a data version. The tag also identifies the server process,
+ *        because versions restart from zero on every start.
+ * @param version The data version.
+ * @param variant The content coding of the representation, e.g. "gzip", empty for the uncompressed one.
+ * @return The quoted entity tag.
+ */
+std::string makeEtag(std::uint64_t version, const std::string& variant = "");
+
+/**
+ * @brief A function that checks an If-None-Match header value against an entity tag.
+ * @param if_none_match The header value, e.g. "\"a\", W/\"b\"" or "*".
+ * @param etag The quoted entity tag of the current representation.
+ * @return True if the client's copy is current, false otherwise.
+ */
+bool etagMatches(const std::string& if_none_match, const std::string& etag);
+
+} // namespace server
+
+#endif // RESPONSE_CACHE_HPP
@@ -6,26 +6,222 @@
  * @version 1.0
  */
 
-#include <jsoncpp/json/json.h>
+#include <algorithm>
+#include <charconv>
+#include "../logging/logger.hpp"
+#include "../metrics/metrics.hpp"
+#include "../serialization/compression.hpp"
+#include "../serialization/json_reader.hpp"
+#include "../serialization/json_writer.hpp"
+#include "../serialization/msgpack.hpp"
+#include "../tracing/trace.hpp"
 #include "../utilities/http_status_codes.hpp"
 #include "server_manager.hpp"
 
 namespace server {
 
-ServerManager::ServerManager(const std::string& db_path, const std::string& host, int port, int concurrency_capacity)
-    : concurrency_capacity_(concurrency_capacity)
+namespace {
+
+// Each served worker reuses its own buffer, so serializing a listing stops allocating once it has warmed up
+serialization::JsonWriter& responseWriter() {
+    thread_local serialization::JsonWriter writer;
+    writer.clear();
+    return writer;
+}
+
+serialization::MsgpackWriter& msgpackWriter() {
+    thread_local serialization::MsgpackWriter writer;
+    writer.clear();
+    return writer;
+}
+
+// The representation of device and location bodies; messages and errors are always JSON
+enum class WireFormat { Json, Msgpack };
+
+// MessagePack when the Accept header asks for it at least as much as for JSON
+WireFormat responseFormat(const served::request& req) {
+    std::string accept = req.header("Accept");
+    if (accept.empty()) {
+        return WireFormat::Json;
+    }
+    double msgpack = std::max(serialization::acceptQuality(accept, "application/msgpack"),
+                              serialization::acceptQuality(accept, "application/x-msgpack"));
+    double json = serialization::acceptQuality(accept, "application/json");
+    return msgpack > 0 && msgpack >= json ? WireFormat::Msgpack : WireFormat::Json;
+}
+
+bool isMsgpackBody(const served::request& req) {
+    std::string content_type = req.header("Content-Type");
+    std::string_view media_type = std::string_view(content_type).substr(0, content_type.find(';'));
+    return media_type == "application/msgpack" || media_type == "application/x-msgpack";
+}
+
+// Sets a 200 response whose body is written by write, which is handed a JsonWriter or a MsgpackWriter
+template <typename Response, typename WriteFn>
+void setPayload(Response &res, WireFormat format, WriteFn write) {
+    res.set_status(HttpStatus::OK);
+    if (format == WireFormat::Msgpack) {
+        tracing::ScopedSpan span("serialize", "msgpack");
+        serialization::MsgpackWriter& writer = msgpackWriter();
+        write(writer);
+        res.set_header("Content-Type", "application/msgpack");
+        res.set_body(writer.str());
+    } else {
+        tracing::ScopedSpan span("serialize", "json");
+        serialization::JsonWriter& writer = responseWriter();
+        write(writer);
+        writer.append('\n');
+        res.set_header("Content-Type", "application/json");
+        res.set_body(writer.str());
+    }
+}
+
+// Answers 400 with the reason in the usual error body
+template <typename Response>
+void setBadRequest(Response &res, const std::string& error) {
+    serialization::JsonWriter& writer = responseWriter();
+    writer.append("{\"error\": ");
+    writer.writeString(error);
+    writer.append("}\n");
+    res.set_status(HttpStatus::BAD_REQUEST);
+    res.set_body(writer.str());
+}
+
+template <typename Reader, typename Value>
+bool readBody(Reader& reader, Value& value, std::string& error) {
+    bool decoded;
+    if constexpr (std::is_same_v<Value, Device>) {
+        decoded = reader.readDevice(value, error);
+    } else {
+        decoded = reader.readLocation(value, error);
+    }
+    if (decoded && !reader.atEnd()) {
+        error = "Unexpected data after the body.";
+        return false;
+    }
+    return decoded;
+}
+
+// Decodes a device or a location from a JSON or MessagePack body, answering 400 with the reason if the body is not one
+template <typename Value>
+bool decodeBody(served::response &res, const served::request &req, Value& value) {
+    tracing::ScopedSpan span("parse_body", "server");
+    const std::string body = req.body();
+    std::string error;
+    bool decoded;
+    if (isMsgpackBody(req)) {
+        serialization::MsgpackReader reader(body);
+        decoded = readBody(reader, value, error);
+    } else {
+        serialization::JsonReader reader(body);
+        decoded = readBody(reader, value, error);
+    }
+    if (!decoded) {
+        setBadRequest(res, error);
+    }
+    return decoded;
+}
+
+// A keyset page of a listing: the rows with an id greater than after_id, at most limit of them
+struct PageRequest {
+    int after_id;
+    int limit;
+};
+
+bool parseNonNegativeInt(const std::string& text, int& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() && value >= 0;
+}
+
+bool parseSequence(const std::string& text, std::uint64_t& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Reads the limit and after_id query parameters, answering 400 if they are malformed
+template <typename Response>
+bool parsePageRequest(Response &res, const served::request &req, const config::Config& config, PageRequest& page) {
+    page = { 0, config.default_page_size };
+    std::string limit = req.query.get("limit");
+    std::string after_id = req.query.get("after_id");
+    if (!limit.empty() && (!parseNonNegativeInt(limit, page.limit) || page.limit == 0)) {
+        res.set_status(HttpStatus::BAD_REQUEST);
+        res.set_body("{\"error\": \"Invalid limit.\"}\n");
+        return false;
+    }
+    if (!after_id.empty() && !parseNonNegativeInt(after_id, page.after_id)) {
+        res.set_status(HttpStatus::BAD_REQUEST);
+        res.set_body("{\"error\": \"Invalid after_id.\"}\n");
+        return false;
+    }
+    if (page.limit > config.max_page_size) {
+        page.limit = config.max_page_size;
+    }
+    return true;
+}
+
+// Pages are fetched with one extra row: if it is there, it is dropped and the last id of the page becomes the cursor
+template <typename Response, typename Row>
+void setNextCursor(Response &res, std::vector<Row>& rows, const PageRequest& page) {
+    if (rows.size() > static_cast<std::size_t>(page.limit)) {
+        rows.pop_back();
+        res.set_header("X-Next-Cursor", std::to_string(rows.back().id));
+    }
+}
+
+// Time spent turning rows into a response body, to compare with db_operation_duration_seconds
+metrics::Histogram& serializeLatency(const char* payload) {
+    return metrics::Registry::global().histogram("http_response_serialize_duration_seconds",
+                                                 "Time spent serializing response bodies", { { "payload", payload } });
+}
+
+// Time spent compressing response bodies, paid once per data version for cached listings
+metrics::Histogram& compressLatency() {
+    static metrics::Histogram& latency = metrics::Registry::global().histogram(
+        "http_response_compress_duration_seconds", "Time spent compressing response bodies");
+    return latency;
+}
+
+// Exposes the counters of a cache that keeps its own statistics
+template <typename StatsFn>
+void registerCacheMetrics(std::vector<metrics::CallbackHandle>& handles, const std::string& cache, StatsFn stats) {
+    metrics::Registry& registry = metrics::Registry::global();
+    handles.push_back(registry.counterCallback("cache_hits_total", "Lookups answered from a cache", { { "cache", cache } },
+                                               [stats] { return static_cast<double>(stats().hits); }));
+    handles.push_back(registry.counterCallback("cache_misses_total", "Lookups that missed a cache", { { "cache", cache } },
+                                               [stats] { return static_cast<double>(stats().misses); }));
+    handles.push_back(registry.gauge("cache_entries", "Entries currently held by a cache", { { "cache", cache } },
+                                     [stats] { return static_cast<double>(stats().size); }));
+}
+
+} // namespace
+
+ServerManager::ServerManager(const config::Config& config)
+    : config_(config)
     , mux_()
-    , database_(std::make_unique<database::DatabaseManager>(db_path))
-    , server_(std::make_unique<served::net::server>(host, std::to_string(port), mux_)){}
+    , database_(std::make_unique<database::DatabaseManager>(config.db_path, config.db_pool_size, config.durabilityProfile()))
+    // Signals are left to the owner, which calls shutdown() so in-flight requests can finish
+    , server_(std::make_unique<served::net::server>(config.host, std::to_string(config.port), mux_, false))
+    , response_cache_(std::make_unique<ResponseCache>(config.response_cache_capacity))
+    , trace_threshold_(config.trace_slow_request_ms)
+    , draining_(false)
+    , in_flight_(0)
+    , shut_down_(false)
+    , query_gate_(std::make_unique<AdmissionGate>("query", config.admission_query_limit, config.admission_queue_limit,
+                                                  std::chrono::milliseconds(config.admission_queue_timeout_ms)))
+    , export_gate_(std::make_unique<AdmissionGate>("export", config.admission_export_limit, config.admission_queue_limit,
+                                                   std::chrono::milliseconds(config.admission_queue_timeout_ms)))
+    , write_gate_(std::make_unique<AdmissionGate>("write", config.admission_write_limit, config.admission_queue_limit,
+                                                  std::chrono::milliseconds(config.admission_queue_timeout_ms)))
+    , change_waiters_(0) {}
 
 ServerManager::~ServerManager() {
-    stop(); // Stop server
-    database_->close();  // Close database connection
+    shutdown(std::chrono::milliseconds(0));  // Stop server and close database connection
 }
 
 void ServerManager::start() {
-    std::cout << "Server Manager is starting..." << std::endl;
-    server_->run(concurrency_capacity_);
+    logging::info() << "Server Manager is starting...";
+    server_->run(config_.workers);
 }
 
 void ServerManager::stop() {
@@ -34,55 +230,212 @@ void ServerManager::stop() {
     }
 }
 
+void ServerManager::shutdown(std::chrono::milliseconds deadline) {
+    if (shut_down_.exchange(true)) {
+        return;
+    }
+    draining_ = true;
+    database_->closeChanges();  // Long-polls return now instead of holding up the drain
+    logging::info() << "Server Manager is shutting down, draining " << in_flight_.load() << " requests in flight...";
+    {
+        std::unique_lock<std::mutex> lock(drain_mutex_);
+        if (!drained_.wait_for(lock, deadline, [this] { return in_flight_ == 0; })) {
+            logging::warn() << in_flight_.load() << " requests still in flight after the " << deadline.count()
+                            << " ms drain deadline";
+        }
+    }
+    stop();
+    logging::Logger::instance().flush();
+    database_->close();  // Waits for the transactions still running, then checkpoints the WAL
+    logging::info() << "Server Manager stopped";
+}
+
 void ServerManager::init() {
+    database_->setCacheCapacities(config_.device_cache_capacity, config_.location_cache_capacity);
+    database_->setDeviceSnapshot(config_.db_device_snapshot);
+    database_->setChangeLogCapacity(static_cast<std::size_t>(config_.change_log_capacity));
     database_->init(); // Initialize database
+    database_->setExplainFilterQueries(config_.db_explain_filter_queries);
+    initMetrics();
     initDeviceRoutes(); // Initialize routes
     initLocationRoutes(); // Initialize routes
+    initChangeRoutes(); // Initialize routes
+}
+
+void ServerManager::initMetrics() {
+    database::DatabaseManager* database = database_.get();
+    ResponseCache* responses = response_cache_.get();
+    registerCacheMetrics(metric_callbacks_, "device", [database] { return database->deviceCacheStats(); });
+    registerCacheMetrics(metric_callbacks_, "location", [database] { return database->locationCacheStats(); });
+    registerCacheMetrics(metric_callbacks_, "response", [responses] { return responses->stats(); });
+    registerCacheMetrics(metric_callbacks_, "statement", [database] { return database->statementCacheStats(); });
+    metrics::Registry& registry = metrics::Registry::global();
+    metric_callbacks_.push_back(registry.gauge("db_data_version", "Number of writes applied since startup", {},
+                                               [database] { return static_cast<double>(database->dataVersion()); }));
+    std::atomic<int>* change_waiters = &change_waiters_;
+    metric_callbacks_.push_back(registry.gauge("http_changes_waiting", "GET /changes long-polls waiting for a change", {},
+                                               [change_waiters] { return static_cast<double>(change_waiters->load()); }));
+    if (config_.db_device_snapshot) {
+        const char* help = "Device filter queries, by whether the snapshot answered them or they ran on SQLite";
+        metric_callbacks_.push_back(registry.counterCallback("db_snapshot_queries_total", help, { { "result", "hit" } },
+            [database] { return static_cast<double>(database->deviceSnapshotStats().hits); }));
+        metric_callbacks_.push_back(registry.counterCallback("db_snapshot_queries_total", help, { { "result", "fallback" } },
+            [database] { return static_cast<double>(database->deviceSnapshotStats().fallbacks); }));
+        metric_callbacks_.push_back(registry.gauge("db_snapshot_rows", "Devices held by the snapshot", {},
+            [database] { return static_cast<double>(database->deviceSnapshotStats().rows); }));
+        metric_callbacks_.push_back(registry.gauge("db_snapshot_tombstones", "Deleted devices the snapshot has not compacted away yet", {},
+            [database] { return static_cast<double>(database->deviceSnapshotStats().tombstones); }));
+    }
+
+    mux_.handle("/metrics")
+        .get(instrument("GET", "/metrics", &ServerManager::handleMetrics));
+}
+
+served::served_req_handler ServerManager::instrument(const std::string& method, const std::string& route,
+                                                     RouteHandler handler) {
+    // Series are resolved here, once per route, so a request only touches atomics
+    metrics::Registry& registry = metrics::Registry::global();
+    metrics::Histogram* latency = &registry.histogram("http_request_duration_seconds",
+                                                      "Time spent handling a request, by route",
+                                                      { { "method", method }, { "route", route } });
+    std::array<metrics::Counter*, 5> responses;
+    for (std::size_t i = 0; i < responses.size(); ++i) {
+        responses[i] = &registry.counter("http_responses_total", "Responses sent, by route and status class",
+                                         { { "method", method }, { "route", route }, { "code", std::to_string(i + 1) + "xx" } });
+    }
+    std::string name = method + " " + route;
+    AdmissionGate* gate = admissionGate(method, route, handler);
+    return [this, handler, latency, responses, name, gate](served::response &res, const served::request &req) {
+        // Counted before draining_ is read: shutdown() sets draining_ before it reads the count, so
+        // every request is either turned away here or waited for
+        ++in_flight_;
+        struct InFlight {
+            ServerManager* server;
+            ~InFlight() {
+                if (--server->in_flight_ == 0 && server->draining_) {
+                    std::lock_guard<std::mutex> lock(server->drain_mutex_);
+                    server->drained_.notify_all();
+                }
+            }
+        } in_flight{ this };
+        if (draining_) {
+            res.set_status(HttpStatus::SERVICE_UNAVAILABLE);
+            res.set_header("Connection", "close");
+            res.set_header("Retry-After", "1");
+            res.set_body("{\"error\": \"Server is shutting down.\"}\n");
+            responses[4]->add();
+            return;
+        }
+        metrics::ScopedTimer timer(*latency);
+        tracing::ScopedTrace trace(trace_threshold_.count() > 0, name, req.url().URI());
+        AdmissionGate::Ticket ticket = gate ? gate->enter() : AdmissionGate::Ticket(nullptr);
+        if (gate && !ticket) {
+            res.set_status(HttpStatus::SERVICE_UNAVAILABLE);
+            res.set_header("Retry-After", "1");
+            res.set_body("{\"error\": \"Server is overloaded, retry later.\"}\n");
+            responses[4]->add();
+            return;
+        }
+        try {
+            (this->*handler)(res, req);
+        } catch (...) {
+            responses[4]->add();  // served answers an escaped exception with a 500
+            const tracing::Trace* finished = trace.finish(HttpStatus::INTERNAL_SERVER_ERROR);
+            if (finished && finished->duration() >= trace_threshold_) {
+                tracing::reportSlowTrace(*finished, config_.trace_dump_dir);
+            }
+            throw;
+        }
+        int status = res.status();
+        int status_class = status / 100;
+        if (status_class >= 1 && status_class <= 5) {
+            responses[status_class - 1]->add();
+        }
+        const tracing::Trace* finished = trace.finish(status);
+        if (finished && finished->duration() >= trace_threshold_) {
+            tracing::reportSlowTrace(*finished, config_.trace_dump_dir);
+        }
+    };
+}
+
+AdmissionGate* ServerManager::admissionGate(const std::string& method, const std::string& route,
+                                            RouteHandler handler) const {
+    if (handler == &ServerManager::handleNotAllowed) {
+        return nullptr;
+    }
+    if (method != "GET") {
+        return write_gate_.get();
+    }
+    if (route == "/devices/export") {
+        return export_gate_.get();
+    }
+    if (route == "/devices" || route == "/devices/stats" || route == "/locations") {
+        return query_gate_.get();
+    }
+    return nullptr;
+}
+
+void ServerManager::handleMetrics(served::response &res, const served::request &req) {
+    res.set_status(HttpStatus::OK);
+    res.set_header("Content-Type", "text/plain; version=0.0.4");
+    res.set_body(metrics::Registry::global().render());
 }
 
 void ServerManager::initDeviceRoutes() {
+    // Registered before /devices/{id}, which would otherwise match "export", "stats" and "batch" as ids
+    mux_.handle("/devices/batch")
+        .post(instrument("POST", "/devices/batch", &ServerManager::handleAddDevices))
+        .get(instrument("GET", "/devices/batch", &ServerManager::handleNotAllowed))
+        .put(instrument("PUT", "/devices/batch", &ServerManager::handleNotAllowed))
+        .del(instrument("DELETE", "/devices/batch", &ServerManager::handleNotAllowed));
+
+    mux_.handle("/devices/export")
+        .get(instrument("GET", "/devices/export", &ServerManager::handleExportDevices))
+        .put(instrument("PUT", "/devices/export", &ServerManager::handleNotAllowed))
+        .del(instrument("DELETE", "/devices/export", &ServerManager::handleNotAllowed))
+        .post(instrument("POST", "/devices/export", &ServerManager::handleNotAllowed));
+
+    mux_.handle("/devices/stats")
+        .get(instrument("GET", "/devices/stats", &ServerManager::handleGetDeviceStats))
+        .put(instrument("PUT", "/devices/stats", &ServerManager::handleNotAllowed))
+        .del(instrument("DELETE", "/devices/stats", &ServerManager::handleNotAllowed))
+        .post(instrument("POST", "/devices/stats", &ServerManager::handleNotAllowed));
+
     mux_.handle("/devices/{id}")
-        .get(std::bind(&ServerManager::handleGetDevice, this, std::placeholders::_1, std::placeholders::_2))
-        .put(std::bind(&ServerManager::handleUpdateDevice, this, std::placeholders::_1, std::placeholders::_2))
-        .del(std::bind(&ServerManager::handleDeleteDevice, this, std::placeholders::_1, std::placeholders::_2))
-        .post(std::bind(&ServerManager::handleNotAllowed, this, std::placeholders::_1, std::placeholders::_2));
+        .get(instrument("GET", "/devices/{id}", &ServerManager::handleGetDevice))
+        .put(instrument("PUT", "/devices/{id}", &ServerManager::handleUpdateDevice))
+        .del(instrument("DELETE", "/devices/{id}", &ServerManager::handleDeleteDevice))
+        .post(instrument("POST", "/devices/{id}", &ServerManager::handleNotAllowed));
 
     mux_.handle("/devices")
-        .get(std::bind(&ServerManager::handleGetDevices, this, std::placeholders::_1, std::placeholders::_2))
-        .post(std::bind(&ServerManager::handleAddDevice, this, std::placeholders::_1, std::placeholders::_2))
-        .put(std::bind(&ServerManager::handleNotAllowed, this, std::placeholders::_1, std::placeholders::_2))
-        .del(std::bind(&ServerManager::handleNotAllowed, this, std::placeholders::_1, std::placeholders::_2));
+        .get(instrument("GET", "/devices", &ServerManager::handleGetDevices))
+        .post(instrument("POST", "/devices", &ServerManager::handleAddDevice))
+        .put(instrument("PUT", "/devices", &ServerManager::handleNotAllowed))
+        .del(instrument("DELETE", "/devices", &ServerManager::handleNotAllowed));
 }
 
 void ServerManager::initLocationRoutes() {
     mux_.handle("/locations/{id}")
-        .get(std::bind(&ServerManager::handleGetLocation, this, std::placeholders::_1, std::placeholders::_2))
-        .put(std::bind(&ServerManager::handleUpdateLocation, this, std::placeholders::_1, std::placeholders::_2))
-        .del(std::bind(&ServerManager::handleDeleteLocation, this, std::placeholders::_1, std::placeholders::_2))
-        .post(std::bind(&ServerManager::handleNotAllowed, this, std::placeholders::_1, std::placeholders::_2));
+        .get(instrument("GET", "/locations/{id}", &ServerManager::handleGetLocation))
+        .put(instrument("PUT", "/locations/{id}", &ServerManager::handleUpdateLocation))
+        .del(instrument("DELETE", "/locations/{id}", &ServerManager::handleDeleteLocation))
+        .post(instrument("POST", "/locations/{id}", &ServerManager::handleNotAllowed));
     
     mux_.handle("/locations")
-        .get(std::bind(&ServerManager::handleGetAllLocations, this, std::placeholders::_1, std::placeholders::_2))
-        .post(std::bind(&ServerManager::handleAddLocation, this, std::placeholders::_1, std::placeholders::_2))
-        .put(std::bind(&ServerManager::handleNotAllowed, this, std::placeholders::_1, std::placeholders::_2))
-        .del(std::bind(&ServerManager::handleNotAllowed, this, std::placeholders::_1, std::placeholders::_2));
+        .get(instrument("GET", "/locations", &ServerManager::handleGetAllLocations))
+        .post(instrument("POST", "/locations", &ServerManager::handleAddLocation))
+        .put(instrument("PUT", "/locations", &ServerManager::handleNotAllowed))
+        .del(instrument("DELETE", "/locations", &ServerManager::handleNotAllowed));
 }
 
 void ServerManager::handleGetDevice(served::response &res, const served::request &req) {
     int id = std::stoi(req.params["id"]);
     auto optionalDevice = database_->getDevice(id);
     if (optionalDevice.has_value()) {
-        Device device = optionalDevice.value();
-        Json::Value jsonDevice;
-        jsonDevice["id"] = device.id;
-        jsonDevice["name"] = device.name;
-        jsonDevice["type"] = device.type;
-        jsonDevice["serial_number"] = device.serial_number;
-        jsonDevice["creation_date"] = device.creation_date;
-        jsonDevice["location_id"] = device.location_id;
-        res.set_status(HttpStatus::OK);
-        res.set_header("Content-Type", "application/json");
-        res.set_body(jsonDevice.toStyledString());
+        static metrics::Histogram& serialize = serializeLatency("device");
+        metrics::ScopedTimer timer(serialize);
+        res.set_header("Vary", "Accept");
+        setPayload(res, responseFormat(req), [&](auto& writer) { writer.writeDevice(optionalDevice.value()); });
     } else {
         res.set_status(HttpStatus::NOT_FOUND);
         res.set_body("{\"error\": \"Device not found.\"}\n");
@@ -91,15 +444,11 @@ void ServerManager::handleGetDevice(served::response &res, const served::request
 
 void ServerManager::handleUpdateDevice(served::response &res, const served::request &req) {
     int id = std::stoi(req.params["id"]);
-    Json::Value jsonRequest;
-    std::istringstream(req.body()) >> jsonRequest;
     Device updatedDevice;
     updatedDevice.id = id;
-    updatedDevice.name = jsonRequest["name"].asString();
-    updatedDevice.type = jsonRequest["type"].asString();
-    updatedDevice.serial_number = jsonRequest["serial_number"].asString();
-    updatedDevice.creation_date = jsonRequest["creation_date"].asString();
-    updatedDevice.location_id = jsonRequest["location_id"].asInt();
+    if (!decodeBody(res, req, updatedDevice)) {
+        return;
+    }
     if (database_->updateDevice(updatedDevice)) {
         res.set_status(HttpStatus::OK);
         res.set_header("Content-Type", "application/json");
@@ -126,83 +475,223 @@ void ServerManager::handleGetDevices(served::response &res, const served::reques
     // Check for the presence of any filter query parameters
     bool hasFilters = false;
     for (const auto & query_param : req.query) {
+        if (query_param.first == "limit" || query_param.first == "after_id") {
+            continue;  // Pagination, not a filter
+        }
         if (!query_param.second.empty()) {
             hasFilters = true;
             break;
         }
     }
-    if (hasFilters) {
-        // Call and return the filtered list
-        handleGetDevicesWithFilters(res, req);
-    } else {
-        // Call and return the list of all devices
-        handleGetAllDevices(res, req);
+    respondCached(res, req, "/devices", [&](RenderedResponse& rendered) {
+        if (hasFilters) {
+            // Call and return the filtered list
+            handleGetDevicesWithFilters(rendered, req);
+        } else {
+            // Call and return the list of all devices
+            handleGetAllDevices(rendered, req);
+        }
+    });
+}
+
+std::shared_ptr<const RenderedResponse> ServerManager::cachedResponse(
+        const std::string& key, std::uint64_t version, const std::function<void(RenderedResponse&)>& render) {
+    auto cached = response_cache_->get(key);
+    if (cached.has_value() && (*cached)->version == version) {
+        return *cached;
+    }
+    std::uint64_t generation = response_cache_->generation(key);
+    auto rendered = std::make_shared<RenderedResponse>();
+    rendered->version = version;
+    render(*rendered);
+    if (rendered->status == HttpStatus::OK || rendered->status == HttpStatus::NO_CONTENT) {
+        response_cache_->put(key, rendered, generation);
+    }
+    return rendered;
+}
+
+void ServerManager::respondCached(served::response &res, const served::request &req, const std::string& path,
+                                  const std::function<void(RenderedResponse&)>& render) {
+    std::string key = responseCacheKey(path, req);
+    std::string variant;
+    if (responseFormat(req) == WireFormat::Msgpack) {
+        variant = "msgpack";
+        key += "#msgpack";  // The renderers negotiate the same format from the request
+    }
+    // Read before rendering: a write racing with the render can only make the entry look older than it is
+    std::uint64_t version = database_->dataVersion();
+    std::shared_ptr<const RenderedResponse> response = cachedResponse(key, version, [&](RenderedResponse& rendered) {
+        tracing::ScopedSpan span("render", "server");
+        render(rendered);
+    });
+    bool cacheable = response->status == HttpStatus::OK || response->status == HttpStatus::NO_CONTENT;
+
+    serialization::ContentEncoding encoding = serialization::ContentEncoding::Identity;
+    res.set_header("Vary", config_.compression_level > 0 ? "Accept, Accept-Encoding" : "Accept");
+    if (config_.compression_level > 0 && cacheable &&
+        response->body.size() >= static_cast<std::size_t>(config_.compression_min_bytes)) {
+        encoding = serialization::negotiateEncoding(req.header("Accept-Encoding"));
     }
+    if (encoding != serialization::ContentEncoding::Identity) {
+        const char* coding = serialization::encodingName(encoding);
+        variant = variant.empty() ? coding : variant + "-" + coding;
+        // Compressed once per data version, format and coding, then replayed to every poller
+        std::shared_ptr<const RenderedResponse> identity = response;
+        response = cachedResponse(key + "#" + coding, version, [&](RenderedResponse& compressed) {
+            metrics::ScopedTimer timer(compressLatency());
+            tracing::ScopedSpan span("compress", "server");
+            compressed.status = identity->status;
+            compressed.headers = identity->headers;
+            if (serialization::compress(identity->body, encoding, config_.compression_level, compressed.body)) {
+                compressed.set_header("Content-Encoding", coding);
+            } else {
+                compressed.body = identity->body;
+            }
+        });
+    }
+
+    if (cacheable) {
+        std::string etag = makeEtag(response->version, variant);
+        std::string ifNoneMatch = req.header("If-None-Match");
+        if (!ifNoneMatch.empty() && etagMatches(ifNoneMatch, etag)) {
+            res.set_status(HttpStatus::NOT_MODIFIED);
+            res.set_header("ETag", etag);
+            return;
+        }
+        res.set_header("ETag", etag);
+    }
+    response->applyTo(res);
 }
 
-void ServerManager::handleGetAllDevices(served::response &res, const served::request &req) {
-    std::vector<Device> devices = database_->getAllDevices();
+void ServerManager::handleGetAllDevices(RenderedResponse &res, const served::request &req) {
+    PageRequest page;
+    if (!parsePageRequest(res, req, config_, page)) {
+        return;
+    }
+    std::vector<Device> devices = database_->getDevicesPage(page.after_id, page.limit + 1);
     if (devices.empty()) {
         res.set_status(HttpStatus::NO_CONTENT);
     } else {
-        Json::Value jsonResponse;
-        for (const auto& device : devices) {
-            Json::Value jsonDevice;
-            jsonDevice["id"] = device.id;
-            jsonDevice["name"] = device.name;
-            jsonDevice["type"] = device.type;
-            jsonDevice["serial_number"] = device.serial_number;
-            jsonDevice["creation_date"] = device.creation_date;
-            jsonDevice["location_id"] = device.location_id;
-            jsonResponse.append(jsonDevice);
-        }
-        res.set_status(HttpStatus::OK);
-        res.set_header("Content-Type", "application/json");
-        res.set_body(jsonResponse.toStyledString());
+        setNextCursor(res, devices, page);
+        static metrics::Histogram& serialize = serializeLatency("devices");
+        metrics::ScopedTimer timer(serialize);
+        setPayload(res, responseFormat(req), [&](auto& writer) { writer.writeDevices(devices); });
     }
 }
 
-void ServerManager::handleGetDevicesWithFilters(served::response &res, const served::request &req) {
-    auto name = req.query.get("name");
-    auto type = req.query.get("type");
-    auto serial_number = req.query.get("serial_number");
-    auto creation_date_start = req.query.get("creation_date_start");
-    auto creation_date_end = req.query.get("creation_date_end");
-    auto location = req.query.get("location");
+void ServerManager::handleGetDevicesWithFilters(RenderedResponse &res, const served::request &req) {
+    std::string name, type, serial_number, creation_date_start, creation_date_end, location;
+    PageRequest page;
+    {
+        tracing::ScopedSpan span("parse_query", "server");
+        name = req.query.get("name");
+        type = req.query.get("type");
+        serial_number = req.query.get("serial_number");
+        creation_date_start = req.query.get("creation_date_start");
+        creation_date_end = req.query.get("creation_date_end");
+        location = req.query.get("location");
+        if (!parsePageRequest(res, req, config_, page)) {
+            return;
+        }
+    }
 
-    auto devices = database_->getDevicesWithFilters(name, type, serial_number, creation_date_start, creation_date_end, location);
+    auto devices = database_->getDevicesWithFilters(name, type, serial_number, creation_date_start, creation_date_end, location,
+                                                    page.after_id, page.limit + 1);
     if(devices.empty()){
         res.set_status(HttpStatus::OK);
         res.set_header("Content-Type", "application/json");
         res.set_body("{\"message\": \"No devices found.\"}\n");
     }
     else {
-        Json::Value jsonResponse;
-        for (const auto& device : devices) {
-            Json::Value jsonDevice;
-            jsonDevice["id"] = device.id;
-            jsonDevice["name"] = device.name;
-            jsonDevice["type"] = device.type;
-            jsonDevice["serial_number"] = device.serial_number;
-            jsonDevice["creation_date"] = device.creation_date;
-            jsonDevice["location_id"] = device.location_id;
-            jsonResponse.append(jsonDevice);
+        setNextCursor(res, devices, page);
+        static metrics::Histogram& serialize = serializeLatency("devices");
+        metrics::ScopedTimer timer(serialize);
+        setPayload(res, responseFormat(req), [&](auto& writer) { writer.writeDevices(devices); });
+    }
+}
+
+void ServerManager::handleExportDevices(served::response &res, const served::request &req) {
+    std::string format = req.query.get("format");
+    if (!format.empty() && format != "ndjson" && format != "json" && format != "msgpack") {
+        res.set_status(HttpStatus::BAD_REQUEST);
+        res.set_body("{\"error\": \"Invalid format.\"}\n");
+        return;
+    }
+    if (format.empty() && responseFormat(req) == WireFormat::Msgpack) {
+        format = "msgpack";
+    }
+    bool asArray = format == "json";
+    bool asMsgpack = format == "msgpack";  // A stream of device maps, the MessagePack counterpart of NDJSON
+
+    // Rows go from SQLite's row buffer through a small serialization buffer straight into the response,
+    // so neither Device objects nor a second copy of the body are ever built
+    const std::size_t flushThreshold = 64 * 1024;
+    serialization::JsonWriter& writer = responseWriter();
+    serialization::MsgpackWriter& packer = msgpackWriter();
+    bool first = true;
+    res.set_status(HttpStatus::OK);
+    res.set_header("Content-Type", asMsgpack ? "application/msgpack" : asArray ? "application/json" : "application/x-ndjson");
+    res.set_header("Vary", config_.compression_level > 0 ? "Accept, Accept-Encoding" : "Accept");
+
+    // Exports are always large, so they are compressed whenever the client accepts it, chunk by chunk
+    serialization::ContentEncoding encoding = serialization::ContentEncoding::Identity;
+    if (config_.compression_level > 0) {
+        encoding = serialization::negotiateEncoding(req.header("Accept-Encoding"));
+    }
+    std::unique_ptr<serialization::Compressor> compressor;
+    if (encoding != serialization::ContentEncoding::Identity) {
+        compressor = std::make_unique<serialization::Compressor>(encoding, config_.compression_level);
+        res.set_header("Content-Encoding", serialization::encodingName(encoding));
+    }
+    thread_local std::string compressed;
+    auto send = [&](bool last) {
+        const std::string& chunk = asMsgpack ? packer.str() : writer.str();
+        if (!compressor) {
+            res << chunk;
+        } else {
+            metrics::ScopedTimer timer(compressLatency());
+            compressed.clear();
+            compressor->write(chunk, compressed);
+            if (last) compressor->finish(compressed);
+            res << compressed;
         }
-        res.set_status(HttpStatus::OK);
-        res.set_header("Content-Type", "application/json");
-        res.set_body(jsonResponse.toStyledString());
+        writer.clear();
+        packer.clear();
+    };
+
+    if (asArray) writer.append('[');
+    bool completed = database_->forEachDevice([&](const DeviceView& device) {
+        if (asMsgpack) {
+            packer.writeDevice(device);
+        } else {
+            if (asArray && !first) writer.append(',');
+            writer.writeDevice(device);
+            if (!asArray) writer.append('\n');
+            first = false;
+        }
+        if (writer.size() + packer.size() >= flushThreshold) {
+            send(false);
+        }
+    });
+    if (asArray) writer.append("]\n");
+    send(true);
+
+    if (!completed) {
+        res.set_status(HttpStatus::INTERNAL_SERVER_ERROR);
+        std::string error = "{\"error\": \"Failed to export devices.\"}\n";
+        if (compressor) {
+            serialization::compress(error, encoding, config_.compression_level, compressed);  // Content-Encoding is already set
+            error = compressed;
+        }
+        res.set_body(error);
     }
 }
 
 void ServerManager::handleAddDevice(served::response &res, const served::request &req) {
-    Json::Value jsonRequest;
-    std::istringstream(req.body()) >> jsonRequest;
     Device newDevice;
-    newDevice.name = jsonRequest["name"].asString();
-    newDevice.type = jsonRequest["type"].asString();
-    newDevice.serial_number = jsonRequest["serial_number"].asString();
-    newDevice.creation_date = jsonRequest["creation_date"].asString();
-    newDevice.location_id = jsonRequest["location_id"].asInt();
+    if (!decodeBody(res, req, newDevice)) {
+        return;
+    }
     if (database_->addDevice(newDevice)) {
         res.set_status(HttpStatus::CREATED);
         res.set_header("Content-Type", "application/json");
@@ -213,18 +702,239 @@ void ServerManager::handleAddDevice(served::response &res, const served::request
     }
 }
 
+void ServerManager::handleAddDevices(served::response &res, const served::request &req) {
+    const std::string body = req.body();
+    const std::size_t maxItems = static_cast<std::size_t>(config_.max_batch_size);
+    std::vector<Device> items;
+    std::vector<std::string> parseErrors;  // Per item, empty if the item parsed
+
+    std::size_t start = body.find_first_not_of(" \t\r\n");
+    if (isMsgpackBody(req)) {
+        // A MessagePack array of device maps, a malformed map only fails that row
+        serialization::MsgpackReader reader(body);
+        std::size_t size = 0;
+        bool valid = reader.readArrayHeader(size);
+        for (std::size_t i = 0; valid && i < size && items.size() <= maxItems; ++i) {
+            Device device;
+            std::string error;
+            bool decoded = reader.readDevice(device, error);
+            valid = !reader.broken();
+            items.push_back(std::move(device));
+            parseErrors.push_back(decoded ? "" : error);
+        }
+        if (!valid || (items.size() <= maxItems && !reader.atEnd())) {
+            setBadRequest(res, "Invalid MessagePack array.");
+            return;
+        }
+    } else if (start != std::string::npos && body[start] == '[') {
+        // A JSON array of devices, a device with a missing or mistyped field only fails that row
+        serialization::JsonReader reader(body);
+        reader.beginArray();
+        while (items.size() <= maxItems && reader.nextElement()) {
+            Device device;
+            std::string error;
+            bool decoded = reader.readDevice(device, error);
+            if (reader.broken()) break;
+            items.push_back(std::move(device));
+            parseErrors.push_back(decoded ? "" : error);
+        }
+        if (reader.broken()) {
+            setBadRequest(res, "Invalid JSON array. " + reader.error());
+            return;
+        }
+        if (items.size() <= maxItems && !reader.atEnd()) {
+            setBadRequest(res, "Invalid JSON array. Unexpected data after the array.");
+            return;
+        }
+    } else {
+        // NDJSON: one device per non-empty line, a malformed line only fails that row
+        std::size_t lineStart = 0;
+        while (lineStart < body.size() && items.size() <= maxItems) {
+            std::size_t lineEnd = body.find('\n', lineStart);
+            if (lineEnd == std::string::npos) lineEnd = body.size();
+            std::string_view line(body.data() + lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+                continue;
+            }
+            serialization::JsonReader reader(line);
+            Device device;
+            std::string error;
+            if (reader.readDevice(device, error) && !reader.atEnd()) {
+                error = "Unexpected data after the device.";
+            }
+            items.push_back(std::move(device));
+            parseErrors.push_back(error);
+        }
+    }
+
+    if (items.empty()) {
+        res.set_status(HttpStatus::BAD_REQUEST);
+        res.set_body("{\"error\": \"No devices in batch.\"}\n");
+        return;
+    }
+    if (items.size() > static_cast<std::size_t>(config_.max_batch_size)) {
+        res.set_status(HttpStatus::BAD_REQUEST);
+        res.set_body("{\"error\": \"Batch exceeds " + std::to_string(config_.max_batch_size) + " devices.\"}\n");
+        return;
+    }
+
+    // Only well-formed rows reach the database; rowIndex maps them back to their position in the request
+    std::vector<Device> devices;
+    std::vector<std::size_t> rowIndex;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        if (parseErrors[i].empty()) {
+            devices.push_back(std::move(items[i]));
+            rowIndex.push_back(i);
+        }
+    }
+
+    database::BatchResult result = database_->addDevices(devices);
+    if (!result.committed) {
+        res.set_status(HttpStatus::INTERNAL_SERVER_ERROR);
+        res.set_body("{\"error\": \"Failed to add devices.\"}\n");
+        return;
+    }
+    for (const auto& rowError : result.errors) {
+        parseErrors[rowIndex[rowError.index]] = rowError.error;
+    }
+
+    serialization::JsonWriter& writer = responseWriter();
+    std::size_t failed = items.size() - result.inserted;
+    writer.append("{\"inserted\":");
+    writer.writeInt(static_cast<long long>(result.inserted));
+    writer.append(",\"failed\":");
+    writer.writeInt(static_cast<long long>(failed));
+    writer.append(",\"errors\":[");
+    bool first = true;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        if (parseErrors[i].empty()) continue;
+        if (!first) writer.append(',');
+        writer.append("{\"index\":");
+        writer.writeInt(static_cast<long long>(i));
+        writer.append(",\"error\":");
+        writer.writeString(parseErrors[i]);
+        writer.append('}');
+        first = false;
+    }
+    writer.append("]}\n");
+    res.set_status(failed == 0 ? HttpStatus::CREATED : HttpStatus::MULTI_STATUS);
+    res.set_header("Content-Type", "application/json");
+    res.set_body(writer.str());
+}
+
+void ServerManager::handleGetDeviceStats(served::response &res, const served::request &req) {
+    std::string group_by = req.query.get("group_by");
+    database::DeviceGrouping grouping;
+    if (group_by == "type") {
+        grouping = database::DeviceGrouping::Type;
+    } else if (group_by == "location") {
+        grouping = database::DeviceGrouping::Location;
+    } else if (group_by == "creation_month") {
+        grouping = database::DeviceGrouping::CreationMonth;
+    } else {
+        setBadRequest(res, "Invalid group_by: expected type, location or creation_month.");
+        return;
+    }
+    // Counted once per data version, then served from the response cache until the next write
+    respondCached(res, req, "/devices/stats", [&](RenderedResponse& rendered) {
+        auto groups = database_->countDevices(grouping);
+        if (!groups.has_value()) {
+            rendered.set_status(HttpStatus::INTERNAL_SERVER_ERROR);
+            rendered.set_body("{\"error\": \"Failed to count devices.\"}\n");
+            return;
+        }
+        static metrics::Histogram& serialize = serializeLatency("device_stats");
+        metrics::ScopedTimer timer(serialize);
+        setPayload(rendered, responseFormat(req), [&](auto& writer) { writer.writeDeviceGroups(group_by, *groups); });
+    });
+}
+
+void ServerManager::initChangeRoutes() {
+    mux_.handle("/changes")
+        .get(instrument("GET", "/changes", &ServerManager::handleGetChanges))
+        .put(instrument("PUT", "/changes", &ServerManager::handleNotAllowed))
+        .del(instrument("DELETE", "/changes", &ServerManager::handleNotAllowed))
+        .post(instrument("POST", "/changes", &ServerManager::handleNotAllowed));
+}
+
+void ServerManager::handleGetChanges(served::response &res, const served::request &req) {
+    std::string since_text = req.query.get("since");
+    std::string limit_text = req.query.get("limit");
+    std::string wait_text = req.query.get("wait");
+    if (since_text.empty()) {
+        // The cursor to follow from: a client takes it, then reads the listings it mirrors
+        res.set_status(HttpStatus::NO_CONTENT);
+        res.set_header("X-Next-Cursor", std::to_string(database_->lastChange()));
+        return;
+    }
+    std::uint64_t since = 0;
+    int limit = config_.default_page_size;
+    int wait_seconds = 0;
+    if (!parseSequence(since_text, since)) {
+        setBadRequest(res, "Invalid since.");
+        return;
+    }
+    if (!limit_text.empty() && (!parseNonNegativeInt(limit_text, limit) || limit == 0)) {
+        setBadRequest(res, "Invalid limit.");
+        return;
+    }
+    if (!wait_text.empty() && !parseNonNegativeInt(wait_text, wait_seconds)) {
+        setBadRequest(res, "Invalid wait.");
+        return;
+    }
+    limit = std::min(limit, config_.max_page_size);
+    std::chrono::milliseconds wait = std::min(std::chrono::milliseconds(static_cast<std::int64_t>(wait_seconds) * 1000),
+                                              std::chrono::milliseconds(config_.changes_max_wait_ms));
+
+    auto changes = database_->getChanges(since, static_cast<std::size_t>(limit));
+    if (changes.has_value() && changes->empty() && wait.count() > 0) {
+        // A waiting long-poll holds a worker, so past the limit it is shed like a full admission queue
+        if (++change_waiters_ > config_.changes_max_waiters) {
+            --change_waiters_;
+            res.set_status(HttpStatus::SERVICE_UNAVAILABLE);
+            res.set_header("Retry-After", "1");
+            res.set_body("{\"error\": \"Too many clients waiting for changes, retry later.\"}\n");
+            return;
+        }
+        bool changed;
+        {
+            tracing::ScopedSpan span("wait_for_changes", "server");
+            changed = database_->waitForChanges(since, wait);
+        }
+        --change_waiters_;
+        if (changed) {
+            changes = database_->getChanges(since, static_cast<std::size_t>(limit));
+        }
+    }
+
+    if (!changes.has_value()) {
+        // The changes after since were dropped from the log, or since comes from before a restart
+        res.set_status(HttpStatus::GONE);
+        res.set_header("X-Next-Cursor", std::to_string(database_->lastChange()));
+        res.set_body("{\"error\": \"Changes since this cursor are no longer available, re-read the listings.\"}\n");
+        return;
+    }
+    if (changes->empty()) {
+        res.set_status(HttpStatus::NO_CONTENT);
+        res.set_header("X-Next-Cursor", std::to_string(since));
+        return;
+    }
+    static metrics::Histogram& serialize = serializeLatency("changes");
+    metrics::ScopedTimer timer(serialize);
+    res.set_header("Vary", "Accept");
+    res.set_header("X-Next-Cursor", std::to_string(changes->back().seq));
+    setPayload(res, responseFormat(req), [&](auto& writer) { writer.writeChanges(*changes); });
+}
+
 void ServerManager::handleGetLocation(served::response &res, const served::request &req) {
     int id = std::stoi(req.params["id"]);
     auto optionalLocation = database_->getLocation(id);
     if (optionalLocation.has_value()) {
-        Location location = optionalLocation.value();
-        Json::Value jsonLocation;
-        jsonLocation["id"] = location.id;
-        jsonLocation["name"] = location.name;
-        jsonLocation["type"] = location.type;
-        res.set_status(HttpStatus::OK);
-        res.set_header("Content-Type", "application/json");
-        res.set_body(jsonLocation.toStyledString());
+        static metrics::Histogram& serialize = serializeLatency("location");
+        metrics::ScopedTimer timer(serialize);
+        res.set_header("Vary", "Accept");
+        setPayload(res, responseFormat(req), [&](auto& writer) { writer.writeLocation(optionalLocation.value()); });
     } else {
         res.set_status(HttpStatus::NOT_FOUND);
         res.set_body("{\"error\": \"Location not found.\"}\n");
@@ -233,12 +943,11 @@ void ServerManager::handleGetLocation(served::response &res, const served::reque
 
 void ServerManager::handleUpdateLocation(served::response &res, const served::request &req) {
     int id = std::stoi(req.params["id"]);
-    Json::Value jsonRequest;
-    std::istringstream(req.body()) >> jsonRequest;
     Location updatedLocation;
     updatedLocation.id = id;
-    updatedLocation.name = jsonRequest["name"].asString();
-    updatedLocation.type = jsonRequest["type"].asString();
+    if (!decodeBody(res, req, updatedLocation)) {
+        return;
+    }
 
     if (database_->updateLocation(updatedLocation)) {
         res.set_status(HttpStatus::OK);
@@ -263,30 +972,30 @@ void ServerManager::handleDeleteLocation(served::response &res, const served::re
 }
 
 void ServerManager::handleGetAllLocations(served::response &res, const served::request &req) {
-    std::vector<Location> locations = database_->getAllLocations();
+    respondCached(res, req, "/locations", [&](RenderedResponse& rendered) { renderLocations(rendered, req); });
+}
+
+void ServerManager::renderLocations(RenderedResponse &res, const served::request &req) {
+    PageRequest page;
+    if (!parsePageRequest(res, req, config_, page)) {
+        return;
+    }
+    std::vector<Location> locations = database_->getLocationsPage(page.after_id, page.limit + 1);
     if (locations.empty()) {
         res.set_status(HttpStatus::NO_CONTENT);
     } else {
-        Json::Value jsonResponse;
-        for (const auto& location : locations) {
-            Json::Value jsonLocation;
-            jsonLocation["id"] = location.id;
-            jsonLocation["name"] = location.name;
-            jsonLocation["type"] = location.type;
-            jsonResponse.append(jsonLocation);
-        }
-        res.set_status(HttpStatus::OK);
-        res.set_header("Content-Type", "application/json");
-        res.set_body(jsonResponse.toStyledString());
+        setNextCursor(res, locations, page);
+        static metrics::Histogram& serialize = serializeLatency("locations");
+        metrics::ScopedTimer timer(serialize);
+        setPayload(res, responseFormat(req), [&](auto& writer) { writer.writeLocations(locations); });
     }
 }
 
 void ServerManager::handleAddLocation(served::response &res, const served::request &req) {
-    Json::Value jsonRequest;
-    std::istringstream(req.body()) >> jsonRequest;
     Location newLocation;
-    newLocation.name = jsonRequest["name"].asString();
-    newLocation.type = jsonRequest["type"].asString();
+    if (!decodeBody(res, req, newLocation)) {
+        return;
+    }
 
     if (database_->addLocation(newLocation)) {
         res.set_status(HttpStatus::CREATED);
@@ -10,19 +10,70 @@
 #define SERVER_MANAGER_HPP
 
 #include <served/served.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include "../database/database_manager.hpp"
+#include "../metrics/metrics.hpp"
+#include "../utilities/config.hpp"
+#include "admission.hpp"
+#include "response_cache.hpp"
 
 namespace server {
 
 class ServerManager {
 private:
+    using RouteHandler = void (ServerManager::*)(served::response &, const served::request &);
+
+    config::Config config_;
     std::unique_ptr<database::DatabaseManager> database_;
     std::unique_ptr<served::net::server> server_;
     served::multiplexer mux_;
-    int concurrency_capacity_;
+    std::unique_ptr<ResponseCache> response_cache_;
+    std::chrono::milliseconds trace_threshold_;  // Requests slower than this are reported, 0 disables tracing
+    std::atomic<bool> draining_;       // Set by shutdown(): new requests are turned away with 503
+    std::atomic<int> in_flight_;       // Requests inside a handler
+    std::atomic<bool> shut_down_;
+    std::mutex drain_mutex_;
+    std::condition_variable drained_;
+    std::unique_ptr<AdmissionGate> query_gate_;   // GET /devices and GET /locations, filtered or not
+    std::unique_ptr<AdmissionGate> export_gate_;  // GET /devices/export
+    std::unique_ptr<AdmissionGate> write_gate_;   // POST, PUT and DELETE
+    std::atomic<int> change_waiters_;             // GET /changes long-polls waiting for a change
+    // The metric callbacks read the members above, so they are declared last and unregistered first
+    std::vector<metrics::CallbackHandle> metric_callbacks_;
 
 private:
+    /**
+     * @brief A member function that wraps a route handler so its latency and status codes are recorded.
+     * @param method The HTTP method the handler is registered for.
+     * @param route The route the handler is registered for, used as a label rather than the request path.
+     * @param handler The handler to be wrapped.
+     * @return The handler to register with the multiplexer.
+     */
+    served::served_req_handler instrument(const std::string& method, const std::string& route, RouteHandler handler);
+
+    /**
+     * @brief A member function that returns the admission gate of a route. Point lookups have none: they are
+     *        cheap and bounded by the connection pool, and are the requests the gates keep workers free for.
+     * @param method The HTTP method of the route.
+     * @param route The route.
+     * @param handler The handler of the route.
+     * @return The gate, nullptr if the route is not limited.
+     */
+    AdmissionGate* admissionGate(const std::string& method, const std::string& route, RouteHandler handler) const;
+
+    /**
+     * @brief A member function that handle GET method for metrics route, in the Prometheus text format.
+     * @param res The response object.
+     * @param req The request object.
+     */
+    void handleMetrics(served::response &res, const served::request &req);
+
     /**
      * @brief A member function that handle GET method for device/id routes.
      * @param res The response object.
@@ -51,6 +102,14 @@ private:
      */
     void handleAddDevice(served::response &res, const served::request &req);
 
+    /**
+     * @brief A member function that handle POST method for device/batch route.
+     *        Accepts a JSON array or NDJSON of devices and inserts them in one transaction.
+     * @param res The response object.
+     * @param req The request object.
+     */
+    void handleAddDevices(served::response &res, const served::request &req);
+
     /**
      * @brief A member function that handle GET method for device routes.
      * @param res The response object.
@@ -60,17 +119,41 @@ private:
 
     /**
      * @brief A member function that handle GET method for device routes with filters.
-     * @param res The response object.
+     * @param res The response to be rendered.
      * @param req The request object.
      */
-    void handleGetDevicesWithFilters(served::response &res, const served::request &req);
+    void handleGetDevicesWithFilters(RenderedResponse &res, const served::request &req);
 
     /**
      * @brief A member function that handle GET method for device routes.
+     * @param res The response to be rendered.
+     * @param req The request object.
+     */
+    void handleGetAllDevices(RenderedResponse &res, const served::request &req);
+
+    /**
+     * @brief A member function that handle GET method for device/export route.
+     *        Writes the whole devices table as NDJSON (default) or as a JSON array with format=json.
+     * @param res The response object.
+     * @param req The request object.
+     */
+    void handleExportDevices(served::response &res, const served::request &req);
+
+    /**
+     * @brief A member function that handle GET method for device/stats route.
+     *        Counts the devices per type, location or creation month, as chosen by group_by.
      * @param res The response object.
      * @param req The request object.
      */
-    void handleGetAllDevices(served::response &res, const served::request &req);
+    void handleGetDeviceStats(served::response &res, const served::request &req);
+
+    /**
+     * @brief A member function that handle GET method for changes route. Returns the writes applied after
+     *        the since cursor, waiting up to wait seconds for one if there are none yet.
+     * @param res The response object.
+     * @param req The request object.
+     */
+    void handleGetChanges(served::response &res, const served::request &req);
 
     /**
      * @brief A member function that handle GET method for location/id routes.
@@ -107,6 +190,38 @@ private:
      */
     void handleGetAllLocations(served::response &res, const served::request &req);
 
+    /**
+     * @brief A member function that renders a page of locations for handleGetAllLocations.
+     * @param res The response to be rendered.
+     * @param req The request object.
+     */
+    void renderLocations(RenderedResponse &res, const served::request &req);
+
+    /**
+     * @brief A member function that returns the cached response under a key if it was rendered at the given
+     *        data version, or renders it and caches it if it is a success.
+     * @param key The cache key.
+     * @param version The current data version.
+     * @param render The function that renders the response on a cache miss.
+     * @return The response.
+     */
+    std::shared_ptr<const RenderedResponse> cachedResponse(const std::string& key, std::uint64_t version,
+                                                           const std::function<void(RenderedResponse&)>& render);
+
+    /**
+     * @brief A member function that answers a listing request from the response cache. The response is rendered
+     *        again only when the data version changed since it was cached, and a client whose If-None-Match
+     *        carries the current ETag gets 304 Not Modified without a body. Bodies above the compression
+     *        threshold are sent gzip or deflate compressed if Accept-Encoding allows it, and the compressed
+     *        body is cached next to the uncompressed one.
+     * @param res The response object.
+     * @param req The request object.
+     * @param path The route of the request, part of the cache key.
+     * @param render The function that renders the response on a cache miss.
+     */
+    void respondCached(served::response &res, const served::request &req, const std::string& path,
+                       const std::function<void(RenderedResponse&)>& render);
+
     /**
      * @brief A member function that handle not allowed methods.
      * @param res The response object.
@@ -117,12 +232,9 @@ private:
 public:
     /**
      * @brief A constructor for the ServerManager class.
-     * @param db_path The path to the database.
-     * @param host The host address.
-     * @param port The port number.
-     * @param concurrency_capacity The number of threads in the thread pool.
+     * @param config The validated configuration: database, listening address, workers, caches and request limits.
      */
-    ServerManager(const std::string& db_path, const std::string& host, int port, int concurrency_capacity);
+    explicit ServerManager(const config::Config& config);
 
     /**
      * @brief A destructor for the ServerManager class.
@@ -134,6 +246,12 @@ public:
      */
     void init();
 
+    /**
+     * @brief A member function that registers the cache metrics and the metrics route for the server.
+     *        The callbacks stay registered until the server is destroyed.
+     */
+    void initMetrics();
+
     /**
      * @brief A member function that initializes the location routes for the server.
      */
@@ -144,6 +262,11 @@ public:
      */
     void initDeviceRoutes();
 
+    /**
+     * @brief A member function that initializes the change feed route for the server.
+     */
+    void initChangeRoutes();
+
     /**
      * @brief A member function that starts the server.
      */
@@ -154,6 +277,15 @@ public:
      */
     void stop();
 
+    /**
+     * @brief A member function that shuts the server down gracefully: new requests are answered with
+     *        503 and "Connection: close", the requests in flight are given until the deadline to finish,
+     *        then the server is stopped, the logs are flushed and the database is closed, checkpointing
+     *        its WAL. Only the first call has an effect.
+     * @param deadline How long the requests in flight are waited for.
+     */
+    void shutdown(std::chrono::milliseconds deadline);
+
 };  // class ServerManager
 
 } // namespace server
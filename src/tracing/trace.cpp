@@ -0,0 +1,155 @@
+/**
+ * @file    trace.cpp
+ * @brief   This file contains the implementation of the Trace, ScopedTrace and ScopedSpan classes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include "../logging/logger.hpp"
+#include "../serialization/json_writer.hpp"
+#include "trace.hpp"
+
+namespace tracing {
+
+namespace {
+
+thread_local Trace* activeTrace = nullptr;
+
+// Chrome trace timestamps are in microseconds
+void writeMicros(serialization::JsonWriter& writer, std::int64_t ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", static_cast<double>(ns) / 1000.0);
+    writer.append(buffer);
+}
+
+void writeEvent(serialization::JsonWriter& writer, const char* name, const char* category, std::int64_t start_ns,
+                std::int64_t duration_ns, long long tid) {
+    writer.append("{\"name\":");
+    writer.writeString(name);
+    writer.append(",\"cat\":");
+    writer.writeString(category);
+    writer.append(",\"ph\":\"X\",\"ts\":");
+    writeMicros(writer, start_ns);
+    writer.append(",\"dur\":");
+    writeMicros(writer, duration_ns);
+    writer.append(",\"pid\":1,\"tid\":");
+    writer.writeInt(tid);
+}
+
+} // namespace
+
+Trace* Trace::current() {
+    return activeTrace;
+}
+
+void Trace::begin(const std::string& name, const std::string& target) {
+    name_ = name;
+    target_ = target;
+    spans_.clear();
+    duration_ns_ = 0;
+    status_ = 0;
+    start_ = Clock::now();
+}
+
+void Trace::end(int status) {
+    duration_ns_ = offset(Clock::now());
+    status_ = status;
+}
+
+std::string Trace::toChromeJson() const {
+    serialization::JsonWriter writer;
+    long long tid = static_cast<long long>(std::hash<std::thread::id>()(std::this_thread::get_id()) % 100000);
+    writer.append("{\"traceEvents\":[");
+    writeEvent(writer, name_.c_str(), "request", 0, duration_ns_, tid);
+    writer.append(",\"args\":{\"target\":");
+    writer.writeString(target_);
+    writer.append(",\"status\":");
+    writer.writeInt(status_);
+    writer.append("}}");
+    for (const auto& span : spans_) {
+        writer.append(',');
+        writeEvent(writer, span.name, span.category, span.start_ns, span.duration_ns, tid);
+        if (span.rows >= 0) {
+            writer.append(",\"args\":{\"rows\":");
+            writer.writeInt(span.rows);
+            if (span.copy_ns >= 0) {
+                writer.append(",\"copy_us\":");
+                writeMicros(writer, span.copy_ns);
+            }
+            writer.append('}');
+        }
+        writer.append('}');
+    }
+    writer.append("],\"displayTimeUnit\":\"ms\"}");
+    return writer.str();
+}
+
+ScopedTrace::ScopedTrace(bool enabled, const std::string& name, const std::string& target)
+    : trace_(nullptr) {
+    if (!enabled || activeTrace) {
+        return;
+    }
+    thread_local Trace trace;
+    trace.begin(name, target);
+    trace_ = &trace;
+    activeTrace = trace_;
+}
+
+ScopedTrace::~ScopedTrace() {
+    if (trace_) {
+        activeTrace = nullptr;
+    }
+}
+
+const Trace* ScopedTrace::finish(int status) {
+    if (!trace_) {
+        return nullptr;
+    }
+    trace_->end(status);
+    return trace_;
+}
+
+ScopedSpan::ScopedSpan(const char* name, const char* category)
+    : trace_(activeTrace)
+    , span_{ name, category, 0, 0, -1, -1 } {
+    if (trace_) {
+        start_ = Clock::now();
+    }
+}
+
+ScopedSpan::~ScopedSpan() {
+    if (trace_) {
+        Clock::time_point now = Clock::now();
+        span_.start_ns = trace_->offset(start_);
+        span_.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_).count();
+        trace_->record(span_);
+    }
+}
+
+void reportSlowTrace(const Trace& trace, const std::string& directory) {
+    std::string json = trace.toChromeJson();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(trace.duration()).count();
+    if (directory.empty()) {
+        logging::warn() << "Slow request (" << ms << " ms): " << json;
+        return;
+    }
+    static std::atomic<std::uint64_t> sequence{ 0 };
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string path = directory + "/trace-" + std::to_string(now) + "-" +
+                       std::to_string(sequence.fetch_add(1, std::memory_order_relaxed)) + ".json";
+    std::ofstream file(path);
+    if (!file || !(file << json << '\n')) {
+        logging::error() << "Failed to write trace file: " << path;
+        return;
+    }
+    logging::warn() << "Slow request (" << ms << " ms), trace written to " << path;
+}
+
+} // namespace tracing
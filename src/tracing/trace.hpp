@@ -0,0 +1,182 @@
+/**
+ * @file    trace.hpp
+ * @brief   This file contains the declaration of the Trace, ScopedTrace and ScopedSpan classes.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tracing {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief A timed section of a request. Names must be string literals, so recording a span never allocates.
+ */
+struct Span {
+    const char* name;
+    const char* category;
+    std::int64_t start_ns;     // Relative to the start of the trace
+    std::int64_t duration_ns;
+    std::int64_t rows;         // Rows read by the section, -1 if not applicable
+    std::int64_t copy_ns;      // Part of the section spent copying rows out of SQLite, -1 if not applicable
+};
+
+/**
+ * @brief The spans recorded while handling one request. Each worker thread reuses a single trace,
+ *        so steady-state tracing does not allocate.
+ */
+class Trace {
+private:
+    std::string name_;
+    std::string target_;
+    Clock::time_point start_;
+    std::int64_t duration_ns_;
+    int status_;
+    std::vector<Span> spans_;
+
+public:
+    /**
+     * @brief A member function that returns the trace of the request being handled by the calling thread.
+     * @return The active trace, nullptr if the thread is not handling a traced request.
+     */
+    static Trace* current();
+
+    /**
+     * @brief A member function that clears the trace and starts it for a new request.
+     * @param name The name of the request, e.g. "GET /devices".
+     * @param target The request target, including the query string.
+     */
+    void begin(const std::string& name, const std::string& target);
+
+    /**
+     * @brief A member function that marks the end of the request.
+     * @param status The status code of the response.
+     */
+    void end(int status);
+
+    /**
+     * @brief A member function that records a finished span.
+     * @param span The span to be recorded.
+     */
+    void record(const Span& span) { spans_.push_back(span); }
+
+    /**
+     * @brief A member function that returns the time since the trace started.
+     * @param now The current time.
+     * @return The elapsed time in nanoseconds.
+     */
+    std::int64_t offset(Clock::time_point now) const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_).count();
+    }
+
+    /**
+     * @brief A member function that returns the duration of the request, valid after end().
+     * @return The duration of the request.
+     */
+    std::chrono::nanoseconds duration() const { return std::chrono::nanoseconds(duration_ns_); }
+
+    /**
+     * @brief A member function that renders the trace in the Chrome trace event format,
+     *        loadable in chrome://tracing or Perfetto.
+     * @return The trace as a single line of JSON.
+     */
+    std::string toChromeJson() const;
+};
+
+/**
+ * @brief An RAII guard that makes a trace active on the calling thread for the duration of a request.
+ *        It does nothing if tracing is disabled or a trace is already active.
+ */
+class ScopedTrace {
+private:
+    Trace* trace_;
+
+public:
+    /**
+     * @brief A constructor for the ScopedTrace class.
+     * @param enabled Whether the request is traced.
+     * @param name The name of the request, e.g. "GET /devices".
+     * @param target The request target, including the query string.
+     */
+    ScopedTrace(bool enabled, const std::string& name, const std::string& target);
+
+    /**
+     * @brief A destructor for the ScopedTrace class. Deactivates the trace.
+     */
+    ~ScopedTrace();
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+    /**
+     * @brief A member function that ends the trace.
+     * @param status The status code of the response.
+     * @return The finished trace, nullptr if the request is not traced.
+     */
+    const Trace* finish(int status);
+};
+
+/**
+ * @brief An RAII guard that records a span into the active trace. Costs a thread-local read when no trace is active.
+ */
+class ScopedSpan {
+private:
+    Trace* trace_;
+    Span span_;
+    Clock::time_point start_;
+
+public:
+    /**
+     * @brief A constructor for the ScopedSpan class.
+     * @param name The name of the span, a string literal.
+     * @param category The category of the span, e.g. "db", a string literal.
+     */
+    ScopedSpan(const char* name, const char* category);
+
+    /**
+     * @brief A destructor for the ScopedSpan class. Records the span.
+     */
+    ~ScopedSpan();
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    /**
+     * @brief A member function that sets the number of rows read by the span.
+     * @param rows The number of rows.
+     */
+    void setRows(std::int64_t rows) { span_.rows = rows; }
+
+    /**
+     * @brief A member function that sets the part of the span spent copying rows out of SQLite.
+     * @param copy_ns The copy time in nanoseconds.
+     */
+    void setCopyTime(std::int64_t copy_ns) { span_.copy_ns = copy_ns; }
+
+    /**
+     * @brief A member function that tells whether the span is recorded, to skip extra measurements otherwise.
+     * @return True if a trace is active on the calling thread.
+     */
+    bool active() const { return trace_ != nullptr; }
+};
+
+/**
+ * @brief A function that reports a slow request: the trace is written to the given directory as
+ *        a Chrome trace file, or logged as a single JSON line if no directory is given.
+ * @param trace The finished trace.
+ * @param directory The directory trace files are written to, empty to log the trace instead.
+ */
+void reportSlowTrace(const Trace& trace, const std::string& directory);
+
+} // namespace tracing
+
+#endif // TRACE_HPP
@@ -0,0 +1,279 @@
+/**
+ * @file    config.cpp
+ * @brief   This file contains the implementation of the Config struct.
+ * @author  Mert Ozer
+ * @date    16.10.2026
+ * @version 1.0
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "../logging/logger.hpp"
+#include "config.hpp"
+
+namespace config {
+
+namespace {
+
+// One setting: how it is parsed into a Config and printed back
+struct Setting {
+    const char* key;
+    const char* help;
+    std::function<bool(Config&, const std::string&)> parse;
+    std::function<std::string(const Config&)> print;
+};
+
+template <typename T>
+bool parseNumber(const std::string& text, T& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+bool parseBool(const std::string& text, bool& value) {
+    if (text == "true" || text == "1" || text == "yes" || text == "on") value = true;
+    else if (text == "false" || text == "0" || text == "no" || text == "off") value = false;
+    else return false;
+    return true;
+}
+
+template <typename T>
+Setting number(const char* key, T Config::*field, const char* help) {
+    return { key, help,
+             [field](Config& config, const std::string& text) { return parseNumber(text, config.*field); },
+             [field](const Config& config) { return std::to_string(config.*field); } };
+}
+
+Setting text(const char* key, std::string Config::*field, const char* help) {
+    return { key, help,
+             [field](Config& config, const std::string& value) { config.*field = value; return true; },
+             [field](const Config& config) { return config.*field; } };
+}
+
+Setting flag(const char* key, bool Config::*field, const char* help) {
+    return { key, help,
+             [field](Config& config, const std::string& value) { return parseBool(value, config.*field); },
+             [field](const Config& config) { return std::string(config.*field ? "true" : "false"); } };
+}
+
+const std::vector<Setting>& settings() {
+    static const std::vector<Setting> all = {
+        text("db_path", &Config::db_path, "Path to the SQLite database"),
+        text("db_durability_profile", &Config::db_durability_profile, "safe, balanced or throughput (can corrupt the database on power loss)"),
+        number("db_pool_size", &Config::db_pool_size, "Pooled database connections, 0 for one per worker"),
+        number("db_mmap_size", &Config::db_mmap_size, "Bytes of the database mapped into memory, -1 for the profile's"),
+        number("db_cache_size", &Config::db_cache_size, "SQLite page cache (pages, or KiB if negative), 0 for the profile's"),
+        number("db_busy_timeout_ms", &Config::db_busy_timeout_ms, "Wait for a database lock, -1 for the profile's"),
+        flag("db_explain_filter_queries", &Config::db_explain_filter_queries, "Log the plan of each device filter query"),
+        flag("db_device_snapshot", &Config::db_device_snapshot, "Answer device filter queries from an in-memory columnar copy"),
+        number("device_cache_capacity", &Config::device_cache_capacity, "Devices cached for GET /devices/{id}, 0 disables"),
+        number("location_cache_capacity", &Config::location_cache_capacity, "Locations cached for GET /locations/{id}, 0 disables"),
+        number("change_log_capacity", &Config::change_log_capacity, "Writes GET /changes can replay"),
+        text("host", &Config::host, "Address to listen on"),
+        number("port", &Config::port, "Port to listen on"),
+        number("workers", &Config::workers, "Threads serving requests, 0 for one per hardware thread"),
+        number("default_page_size", &Config::default_page_size, "Page size when a listing has no limit"),
+        number("max_page_size", &Config::max_page_size, "Larger limits are clamped to this value"),
+        number("max_batch_size", &Config::max_batch_size, "Devices accepted in one POST /devices/batch"),
+        number("response_cache_capacity", &Config::response_cache_capacity, "Rendered listing pages cached, 0 disables"),
+        number("trace_slow_request_ms", &Config::trace_slow_request_ms, "Trace requests slower than this, 0 disables"),
+        text("trace_dump_dir", &Config::trace_dump_dir, "Directory for slow request traces, empty to log them"),
+        number("compression_level", &Config::compression_level, "gzip/deflate level from 1 to 9, 0 disables compression"),
+        number("compression_min_bytes", &Config::compression_min_bytes, "Smaller listing bodies are sent uncompressed"),
+        number("shutdown_timeout_ms", &Config::shutdown_timeout_ms, "Drain deadline for requests in flight on SIGTERM"),
+        number("admission_query_limit", &Config::admission_query_limit, "Listings and filters running at once, 0 for workers/2"),
+        number("admission_export_limit", &Config::admission_export_limit, "Exports running at once, 0 for workers/8"),
+        number("admission_write_limit", &Config::admission_write_limit, "Writes running at once, 0 for workers/2"),
+        number("admission_queue_limit", &Config::admission_queue_limit, "Requests of a class waiting for a slot, -1 for workers/4"),
+        number("admission_queue_timeout_ms", &Config::admission_queue_timeout_ms, "Queued requests get 503 after this long"),
+        number("changes_max_wait_ms", &Config::changes_max_wait_ms, "Longest wait of a GET /changes long-poll"),
+        number("changes_max_waiters", &Config::changes_max_waiters, "GET /changes long-polls waiting at once, -1 for workers/4"),
+        text("log_level", &Config::log_level, "debug, info, warn, error or off"),
+        text("log_format", &Config::log_format, "text or json"),
+        number("log_rate_limit_per_second", &Config::log_rate_limit_per_second, "Repeats of a message logged per second, 0 for no limit"),
+    };
+    return all;
+}
+
+std::string trim(const std::string& text) {
+    std::size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    std::size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+// "key = value" lines; blank lines and lines starting with '#' are skipped
+bool readFile(Config& config, const std::string& path, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot read configuration file " + path;
+        return false;
+    }
+    std::string line;
+    for (int number = 1; std::getline(file, line); ++number) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+        std::size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            error = path + ":" + std::to_string(number) + ": expected key = value";
+            return false;
+        }
+        if (!config.set(trim(line.substr(0, equals)), trim(line.substr(equals + 1)), error)) {
+            error = path + ":" + std::to_string(number) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string environmentName(const char* key) {
+    std::string name = "DEVICE_SERVER_";
+    for (const char* c = key; *c; ++c) {
+        name += static_cast<char>(std::toupper(static_cast<unsigned char>(*c)));
+    }
+    return name;
+}
+
+} // namespace
+
+bool Config::set(const std::string& key, const std::string& value, std::string& error) {
+    for (const auto& setting : settings()) {
+        if (key == setting.key) {
+            if (!setting.parse(*this, value)) {
+                error = "invalid value for " + key + ": '" + value + "'";
+                return false;
+            }
+            return true;
+        }
+    }
+    error = "unknown setting " + key;
+    return false;
+}
+
+std::optional<Config> Config::load(int argc, const char* const argv[], std::string& error) {
+    // The file goes first whatever the position of --config, so that flags always override it
+    std::string file;
+    if (const char* path = std::getenv("DEVICE_SERVER_CONFIG")) file = path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--config=", 0) == 0) file = arg.substr(9);
+    }
+
+    Config config;
+    if (!file.empty() && !readFile(config, file, error)) {
+        return std::nullopt;
+    }
+    for (const auto& setting : settings()) {
+        std::string name = environmentName(setting.key);
+        if (const char* value = std::getenv(name.c_str())) {
+            if (!config.set(setting.key, value, error)) {
+                error = name + ": " + error;
+                return std::nullopt;
+            }
+        }
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::size_t equals = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || equals == std::string::npos) {
+            error = "expected --key=value, got " + arg;
+            return std::nullopt;
+        }
+        std::string key = arg.substr(2, equals - 2);
+        if (key != "config" && !config.set(key, arg.substr(equals + 1), error)) {
+            return std::nullopt;
+        }
+    }
+    if (!config.validate(error)) {
+        return std::nullopt;
+    }
+    return config;
+}
+
+bool Config::validate(std::string& error) {
+    if (!database::DurabilityProfile::fromName(db_durability_profile)) {
+        error = "db_durability_profile must be safe, balanced or throughput";
+    } else if (!logging::levelFromName(log_level)) {
+        error = "log_level must be debug, info, warn, error or off";
+    } else if (!logging::formatFromName(log_format)) {
+        error = "log_format must be text or json";
+    } else if (db_path.empty()) {
+        error = "db_path must not be empty";
+    } else if (port < 1 || port > 65535) {
+        error = "port must be between 1 and 65535";
+    } else if (workers < 0 || db_pool_size < 0) {
+        error = "workers and db_pool_size must not be negative";
+    } else if (db_mmap_size < -1 || db_busy_timeout_ms < -1) {
+        error = "db_mmap_size and db_busy_timeout_ms must be -1 or more";
+    } else if (device_cache_capacity < 0 || location_cache_capacity < 0 || response_cache_capacity < 0) {
+        error = "cache capacities must not be negative";
+    } else if (default_page_size < 1 || max_page_size < default_page_size) {
+        error = "default_page_size must be at least 1 and at most max_page_size";
+    } else if (max_batch_size < 1) {
+        error = "max_batch_size must be at least 1";
+    } else if (trace_slow_request_ms < 0 || log_rate_limit_per_second < 0 || shutdown_timeout_ms < 0) {
+        error = "trace_slow_request_ms, log_rate_limit_per_second and shutdown_timeout_ms must not be negative";
+    } else if (compression_level < 0 || compression_level > 9 || compression_min_bytes < 0) {
+        error = "compression_level must be between 0 and 9 and compression_min_bytes must not be negative";
+    } else if (admission_query_limit < 0 || admission_export_limit < 0 || admission_write_limit < 0 ||
+               admission_queue_limit < -1 || admission_queue_timeout_ms < 0) {
+        error = "admission limits must not be negative";
+    } else if (change_log_capacity < 1 || changes_max_wait_ms < 0 || changes_max_waiters < -1) {
+        error = "change_log_capacity must be at least 1 and changes_max_wait_ms and changes_max_waiters must not be negative";
+    } else {
+        if (workers == 0) {
+            workers = std::max(1u, std::thread::hardware_concurrency());  // 0 when the count is unknown
+        }
+        if (db_pool_size == 0) {
+            db_pool_size = workers;  // Every worker can then hold a connection without waiting
+        }
+        // A queued request holds a worker too, so the defaults keep some workers free for point lookups
+        if (admission_query_limit == 0) admission_query_limit = std::max(1, workers / 2);
+        if (admission_export_limit == 0) admission_export_limit = std::max(1, workers / 8);
+        if (admission_write_limit == 0) admission_write_limit = std::max(1, workers / 2);
+        if (admission_queue_limit == -1) admission_queue_limit = std::max(1, workers / 4);
+        // A waiting long-poll holds a worker, like a queued request
+        if (changes_max_waiters == -1) changes_max_waiters = std::max(1, workers / 4);
+        return true;
+    }
+    return false;
+}
+
+database::DurabilityProfile Config::durabilityProfile() const {
+    database::DurabilityProfile profile =
+        database::DurabilityProfile::fromName(db_durability_profile).value_or(database::DurabilityProfile::balanced());
+    if (db_mmap_size >= 0) profile.mmap_size = db_mmap_size;
+    if (db_cache_size != 0) profile.cache_size = db_cache_size;
+    if (db_busy_timeout_ms >= 0) profile.busy_timeout_ms = db_busy_timeout_ms;
+    return profile;
+}
+
+std::string Config::describe() const {
+    std::string out;
+    for (const auto& setting : settings()) {
+        if (!out.empty()) out += '\n';
+        out += setting.key;
+        out += '=';
+        out += setting.print(*this);
+    }
+    return out;
+}
+
+std::string Config::usage() {
+    std::string out = "Usage: server [--config=PATH] [--key=value ...]\n"
+                      "Settings, also read from DEVICE_SERVER_<KEY> and from the configuration file as key = value:\n";
+    Config defaults;
+    for (const auto& setting : settings()) {
+        std::string line = std::string("  --") + setting.key + "=" + setting.print(defaults);
+        line.resize(std::max<std::size_t>(line.size() + 1, 44), ' ');
+        out += line + setting.help + "\n";
+    }
+    return out;
+}
+
+} // namespace config
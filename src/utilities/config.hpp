@@ -1,6 +1,6 @@
 /**
  * @file    config.hpp
- * @brief   This file contains the declaration of the config parameters for the project.
+ * @brief   This file contains the declaration of the Config struct, the runtime configuration of the server.
  * @author  Mert Ozer
  * @date    26.11.2023
  * @version 1.0
@@ -9,14 +9,104 @@
 #ifndef CONFIG_HPP
 #define CONFIG_HPP
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "../database/durability_profile.hpp"
 
-// DatabaseManager configuration
-#define PATH_TO_DB "../device.db"
+namespace config {
 
-// ServerManager configuration
-#define LOCAL_HOST "0.0.0.0"
-#define PORT 8080
-#define THREAD_POOL_SIZE 1
+/**
+ * @brief The settings of the server. Each one is read, in increasing precedence, from its default below,
+ *        the configuration file, a DEVICE_SERVER_<KEY> environment variable and a --key=value flag.
+ */
+struct Config {
+    // DatabaseManager configuration
+    std::string db_path = "../device.db";
+    std::string db_durability_profile = "balanced";  // "safe", "balanced" or "throughput" (unsafe on power loss)
+    int db_pool_size = 0;                  // Pooled database connections, 0 for one per worker
+    std::int64_t db_mmap_size = -1;        // Overrides the mmap_size of the profile in bytes, -1 keeps it
+    int db_cache_size = 0;                 // Overrides the cache_size of the profile (pages, or KiB if negative), 0 keeps it
+    int db_busy_timeout_ms = -1;           // Overrides the busy timeout of the profile, -1 keeps it
+    bool db_explain_filter_queries = false;  // Log EXPLAIN QUERY PLAN of each device filter combination on first use
+    bool db_device_snapshot = false;       // Answer device filter queries from an in-memory columnar copy of the table
+    int device_cache_capacity = 10000;     // Devices kept in the GET /devices/{id} cache, 0 disables it
+    int location_cache_capacity = 1000;    // Locations kept in the GET /locations/{id} cache, 0 disables it
+    int change_log_capacity = 100000;      // Writes GET /changes can replay; older cursors get 410 Gone
+
+    // ServerManager configuration
+    std::string host = "0.0.0.0";
+    int port = 8080;
+    int workers = 0;                       // Threads serving requests, 0 for one per hardware thread
+    int default_page_size = 100;           // Page size of GET /devices and GET /locations when no limit is given
+    int max_page_size = 1000;              // Larger limits are clamped to this value
+    int max_batch_size = 10000;            // Maximum number of devices in one POST /devices/batch
+    int response_cache_capacity = 256;     // Rendered GET /devices and GET /locations pages kept for pollers
+    int trace_slow_request_ms = 250;       // Requests slower than this are reported with their trace, 0 disables tracing
+    std::string trace_dump_dir;            // Directory for Chrome trace files of slow requests, empty to log them instead
+    int compression_level = 6;             // zlib level of gzip/deflate responses, from 1 (fastest) to 9, 0 disables compression
+    int compression_min_bytes = 1024;      // Smaller listing bodies are sent uncompressed
+    int shutdown_timeout_ms = 10000;       // How long requests in flight may finish after SIGTERM or SIGINT
+    int admission_query_limit = 0;         // Listings and filtered queries running at once, 0 for half the workers
+    int admission_export_limit = 0;        // Exports running at once, 0 for an eighth of the workers
+    int admission_write_limit = 0;         // Writes running at once, 0 for half the workers
+    int admission_queue_limit = -1;        // Requests of each class waiting for a slot, -1 for a quarter of the workers
+    int admission_queue_timeout_ms = 100;  // Waiting requests are answered with 503 after this long
+    int changes_max_wait_ms = 30000;       // Longest wait a GET /changes long-poll may ask for
+    int changes_max_waiters = -1;          // GET /changes long-polls waiting at once, -1 for a quarter of the workers
+
+    // Logger configuration
+    std::string log_level = "info";        // "debug", "info", "warn", "error" or "off"
+    std::string log_format = "text";       // "text" or "json" (one JSON object per line)
+    int log_rate_limit_per_second = 20;    // Repeats of a message logged per second, 0 for no limit
+
+    /**
+     * @brief A member function that builds the configuration from the defaults, the configuration file,
+     *        the environment and the command line, and validates it. The file is the one given with
+     *        --config=PATH or DEVICE_SERVER_CONFIG; without either no file is read.
+     * @param argc The number of command line arguments.
+     * @param argv The command line arguments.
+     * @param error Set to the reason the configuration was rejected.
+     * @return The configuration, an empty optional if a source is unreadable or a value is invalid.
+     */
+    static std::optional<Config> load(int argc, const char* const argv[], std::string& error);
+
+    /**
+     * @brief A member function that returns the usage text listing every setting.
+     * @return The usage text.
+     */
+    static std::string usage();
+
+    /**
+     * @brief A member function that sets one setting from its text form.
+     * @param key The name of the setting, e.g. "workers".
+     * @param value The value of the setting.
+     * @param error Set to the reason the setting was rejected.
+     * @return True if the key is known and the value has the right type, false otherwise.
+     */
+    bool set(const std::string& key, const std::string& value, std::string& error);
+
+    /**
+     * @brief A member function that checks the settings against each other and their ranges,
+     *        and resolves the automatic ones (workers, db_pool_size and the admission limits).
+     * @param error Set to the reason the configuration was rejected.
+     * @return True if the configuration is usable, false otherwise.
+     */
+    bool validate(std::string& error);
+
+    /**
+     * @brief A member function that returns the durability profile with the overrides applied.
+     * @return The profile, balanced if db_durability_profile is unknown.
+     */
+    database::DurabilityProfile durabilityProfile() const;
+
+    /**
+     * @brief A member function that describes every setting, one "key=value" per line, for the startup log.
+     * @return The description.
+     */
+    std::string describe() const;
+};
 
+} // namespace config
 
 #endif // CONFIG_HPP
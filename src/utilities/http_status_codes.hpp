@@ -16,6 +16,7 @@ namespace HttpStatus {
     constexpr int CREATED = 201;
     constexpr int ACCEPTED = 202;
     constexpr int NO_CONTENT = 204;
+    constexpr int MULTI_STATUS = 207;
 
     // Redirection
     constexpr int MOVED_PERMANENTLY = 301;
@@ -33,6 +34,7 @@ namespace HttpStatus {
     constexpr int METHOD_NOT_ALLOWED = 405;
     constexpr int NOT_ACCEPTABLE = 406;
     constexpr int CONFLICT = 409;
+    constexpr int GONE = 410;
 
     // ServerManager Errors
     constexpr int INTERNAL_SERVER_ERROR = 500;
@@ -9,7 +9,9 @@
 #ifndef METADATA_HPP
 #define METADATA_HPP
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 
 struct Device {
@@ -21,11 +23,60 @@ struct Device {
     int location_id; // Add location_id to link with the locations table
 };
 
+// A non-owning view of a devices row, valid only while the row is being visited
+struct DeviceView {
+    int id;
+    std::string_view name;
+    std::string_view type;
+    std::string_view serial_number;
+    std::string_view creation_date;
+    int location_id;
+};
+
 struct Location {
     int id;
     std::string name;
     std::string type;
 };
 
+// The number of devices sharing a value of the column they are grouped by
+struct DeviceGroup {
+    std::string key;   // The type, the creation month (yyyy-mm) or the location name
+    int location_id;   // Set when grouped by location, 0 otherwise
+    long long count;
+};
+
+enum class ChangeEntity : std::uint8_t {
+    Device,
+    Location,
+};
+
+enum class ChangeOperation : std::uint8_t {
+    Insert,
+    Update,
+    Delete,
+};
+
+// One write recorded in the change log, identified by its sequence number
+struct Change {
+    std::uint64_t seq;
+    int id;                     // The id of the device or location written
+    ChangeEntity entity;
+    ChangeOperation operation;
+};
+
+// The names of the entities and operations in the change feed
+inline std::string_view changeEntityName(ChangeEntity entity) {
+    return entity == ChangeEntity::Device ? "device" : "location";
+}
+
+inline std::string_view changeOperationName(ChangeOperation operation) {
+    switch (operation) {
+        case ChangeOperation::Insert: return "insert";
+        case ChangeOperation::Update: return "update";
+        default: return "delete";
+    }
+}
+
 
 #endif // METADATA_HPP